@@ -0,0 +1,11 @@
+#!/bin/bash
+
+set -e
+
+BENCH=${1:-churn}
+shift || true
+
+g++ -std=c++17 -pthread -O2 $CXXFLAGS -I./ bench/${BENCH}_bench.cpp -o ${BENCH}_bench
+./${BENCH}_bench "$@"
+
+rm ${BENCH}_bench
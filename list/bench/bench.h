@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+
+namespace bench {
+
+// Keeps the optimizer from discarding a computed value.
+template <class T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// The average wall time of one run of `body` in seconds, running it for at
+// least `min_seconds` (and at least once).
+template <class Body>
+double SecondsPerRun(Body&& body, double min_seconds = 0.2) {
+    using Clock = std::chrono::steady_clock;
+    size_t runs = 0;
+    const auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do {
+        body();
+        ++runs;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < min_seconds);
+    return elapsed.count() / runs;
+}
+
+}  // namespace bench
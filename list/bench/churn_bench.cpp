@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <list>
+#include <string>
+#include "bench/bench.h"
+#include "src/list.h"
+
+
+// A queue of about `size` elements: push at the back, pop at the front.
+template <class List>
+double QueueChurn(size_t size, size_t operations) {
+    List list(size, 1);
+    return bench::SecondsPerRun([&] {
+        for (size_t i = 0; i < operations; ++i) {
+            list.push_back(i);
+            list.pop_front();
+        }
+        bench::DoNotOptimize(list);
+    }) / operations;
+}
+
+// Walks a list of `size` elements, erasing every other one and inserting
+// a replacement in front of the next, so freed nodes are reused at once.
+template <class List>
+double EraseInsert(size_t size) {
+    List list(size, 1);
+    return bench::SecondsPerRun([&] {
+        auto it = list.begin();
+        while (it != list.end()) {
+            it = list.erase(it);
+            if (it == list.end()) {
+                break;
+            }
+            list.insert(it, 2);
+            ++it;
+        }
+        bench::DoNotOptimize(list);
+    }) / size;
+}
+
+// Builds a list of `size` elements with resize() and clears it.
+template <class List>
+double Rebuild(size_t size) {
+    List list;
+    return bench::SecondsPerRun([&] {
+        list.resize(size);
+        list.clear();
+        bench::DoNotOptimize(list);
+    }) / size;
+}
+
+// Creates `count` lists of two elements each and destroys them.
+template <class List>
+double ShortLived(size_t count) {
+    return bench::SecondsPerRun([&] {
+        for (size_t i = 0; i < count; ++i) {
+            List list;
+            list.push_back(i);
+            list.push_back(i);
+            bench::DoNotOptimize(list);
+        }
+    }) / count;
+}
+
+template <class List>
+void Run(const char* name, size_t size, size_t operations) {
+    std::printf("%-20s %12.2f %12.2f %12.2f %12.2f\n", name, QueueChurn<List>(size, operations) * 1e9,
+                EraseInsert<List>(size) * 1e9, Rebuild<List>(size) * 1e9, ShortLived<List>(operations) * 1e9);
+}
+
+
+// Allocation-bound list workloads on std::list, task::list and
+// task::pooled_list, in nanoseconds per element operation (per list for
+// the short-lived two-element lists).
+// Usage: churn_bench [size] [operations]
+int main(int argc, char** argv) {
+    const size_t size = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const size_t operations = argc > 2 ? std::stoul(argv[2]) : 1000000;
+
+    std::printf("size = %zu\n", size);
+    std::printf("%-20s %12s %12s %12s %12s\n", "", "queue ns", "erase+ins ns", "rebuild ns", "2-list ns");
+    Run<std::list<int>>("std::list", size, operations);
+    Run<task::list<int>>("task::list", size, operations);
+    Run<task::pooled_list<int>>("task::pooled_list", size, operations);
+    return 0;
+}
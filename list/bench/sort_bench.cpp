@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <random>
+#include <string>
+#include "bench/bench.h"
+#include "src/list.h"
+
+
+// Best time of `runs` sorts of a list of `size` random ints. The values
+// are redrawn before every sort, in the node order the last sort left.
+template <class List>
+double Sort(size_t size, size_t runs) {
+    std::mt19937 rand(size);
+    List list(size);
+    double best = 0;
+    for (size_t run = 0; run < runs; ++run) {
+        for (int& value : list) {
+            value = rand();
+        }
+        const double seconds = bench::SecondsPerRun([&] {
+            list.sort();
+            bench::DoNotOptimize(list);
+        }, 0);
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+template <class List>
+void Run(const char* name, size_t size, size_t runs) {
+    const double seconds = Sort<List>(size, runs);
+    std::printf("%-20s %12.3f %12.1f\n", name, seconds, seconds / size * 1e9);
+    std::fflush(stdout);
+}
+
+
+// list::sort on std::list, task::list and task::pooled_list. Each list
+// type runs in a process of its own: freeing one type's sorted nodes
+// scrambles the heap the next type would allocate from.
+// Usage: sort_bench [size] [runs] [std|task|pooled]
+int main(int argc, char** argv) {
+    const size_t size = argc > 1 ? std::stoul(argv[1]) : 10000000;
+    const size_t runs = argc > 2 ? std::stoul(argv[2]) : 3;
+    const std::string kind = argc > 3 ? argv[3] : "";
+
+    if (kind == "std") {
+        Run<std::list<int>>("std::list", size, runs);
+    } else if (kind == "task") {
+        Run<task::list<int>>("task::list", size, runs);
+    } else if (kind == "pooled") {
+        Run<task::pooled_list<int>>("task::pooled_list", size, runs);
+    } else {
+        std::printf("size = %zu\n", size);
+        std::printf("%-20s %12s %12s\n", "", "seconds", "ns/element");
+        std::fflush(stdout);
+        for (const char* each : {"std", "task", "pooled"}) {
+            const std::string command = std::string(argv[0]) + " " + std::to_string(size) + " " +
+                                        std::to_string(runs) + " " + each;
+            if (std::system(command.c_str()) != 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <string>
+#include "bench/bench.h"
+#include "src/list.h"
+#include "src/unrolled_list.h"
+
+
+// Sums a list of `size` elements.
+template <class List>
+double Iterate(size_t size) {
+    List list(size, 1);
+    return bench::SecondsPerRun([&] {
+        size_t sum = 0;
+        for (int value : list) {
+            sum += value;
+        }
+        bench::DoNotOptimize(sum);
+    }) / size;
+}
+
+// Builds a list of `size` elements with push_back and push_front.
+template <class List>
+double PushBoth(size_t size) {
+    return bench::SecondsPerRun([&] {
+        List list;
+        for (size_t i = 0; i < size; ++i) {
+            if (i % 2 == 0) {
+                list.push_back(i);
+            } else {
+                list.push_front(i);
+            }
+        }
+        bench::DoNotOptimize(list);
+    }) / size;
+}
+
+// Walks a list of `size` elements inserting an element after every one,
+// doubling it, and then erasing every other element again.
+template <class List>
+double InsertErase(size_t size) {
+    List list(size, 1);
+    return bench::SecondsPerRun([&] {
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            it = list.insert(std::next(it), 2);
+        }
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            it = list.erase(it);
+        }
+        bench::DoNotOptimize(list);
+    }) / (2 * size);
+}
+
+template <class List>
+void Run(const char* name, size_t size) {
+    std::printf("%-20s %12.2f %12.2f %12.2f\n", name, Iterate<List>(size) * 1e9,
+                PushBoth<List>(size) * 1e9, InsertErase<List>(size) * 1e9);
+}
+
+
+// task::unrolled_list against task::list on ints, in nanoseconds per
+// element.
+// Usage: unrolled_bench [size]
+int main(int argc, char** argv) {
+    const size_t size = argc > 1 ? std::stoul(argv[1]) : 1000000;
+
+    std::printf("size = %zu\n", size);
+    std::printf("%-20s %12s %12s %12s\n", "", "iterate ns", "push ns", "ins+erase ns");
+    Run<task::list<int>>("task::list", size);
+    Run<task::pooled_list<int>>("task::pooled_list", size);
+    Run<task::unrolled_list<int>>("task::unrolled_list", size);
+    return 0;
+}
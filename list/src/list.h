@@ -1,5 +1,8 @@
 #pragma once
+#include <functional>
 #include <iterator>
+#include <memory>
+#include "pool_allocator.h"
 
 
 namespace task {
@@ -8,21 +11,34 @@ namespace task {
     class list {
       private:
 
-        class Node {
+        // The links of a node; the list's sentinel is just this, with no T.
+        struct Link {
+            Link *next;
+            Link *prev;
+        };
+
+        class Node : public Link {
         public:
             T data;
-            Node *next;
-            Node *prev;
 
-            Node(Node* n, Node* p) : next(n), prev(p) {};
-            Node(const T& d, Node* n, Node* p) : data(d), next(n), prev(p) {};
-            Node(T&& d, Node* n, Node* p) : data(std::move(d)), next(n), prev(p) {};
+            // Constructs data from args, value-initialized if there are none.
+            template <class... Args>
+            Node(Link* n, Link* p, Args&&... args) : Link{n, p}, data(std::forward<Args>(args)...) {};
         };
 
+        static T& value(Link* link) {
+            return static_cast<Node*>(link)->data;
+        }
+        static const T& value(const Link* link) {
+            return static_cast<const Node*>(link)->data;
+        }
+
         using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+        using node_traits = std::allocator_traits<allocator_type>;
         allocator_type allocator;
-        Node *head;
-        Node *tail;
+        // next is the first node and prev the last; both point back at the
+        // sentinel itself when the list is empty, and end() is the sentinel.
+        Link sentinel;
         size_t size_;
 
       public:
@@ -46,7 +62,7 @@ namespace task {
             bool operator!=(iterator other) const;
             friend class list;
         private:
-            Node *cur;
+            Link *cur;
         };
 
 
@@ -71,24 +87,24 @@ namespace task {
             bool operator!=(const_iterator other) const;
             friend class list;
         private:
-            const Node *cur;
+            const Link *cur;
         };
 
         using reverse_iterator = std::reverse_iterator<iterator>;
         using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-        list();
-        explicit list(const Alloc& alloc);
+        list() noexcept;
+        explicit list(const Alloc& alloc) noexcept;
         list(size_t count, const T& value, const Alloc& alloc = Alloc());
         explicit list(size_t count, const Alloc& alloc = Alloc());
 
         ~list();
 
         list(const list& other);
-        list(list&& other);
+        list(list&& other) noexcept;
 
         list& operator=(const list& other);
-        list& operator=(list&& other);
+        list& operator=(list&& other) noexcept;
 
         Alloc get_allocator() const;
 
@@ -137,12 +153,50 @@ namespace task {
         void emplace_front(Args&&... args);
         void resize(size_t count);
         void swap(list& other);
+        // merge, splice, remove and unique only relink nodes: they never
+        // allocate, and iterators keep pointing at the elements they did.
         void merge(list& other);
+        void merge(list&& other);
+        template <class Compare>
+        void merge(list& other, Compare comp);
+        template <class Compare>
+        void merge(list&& other, Compare comp);
         void splice(const_iterator pos, list& other);
+        void splice(const_iterator pos, list&& other);
+        void splice(const_iterator pos, list& other, const_iterator it);
+        void splice(const_iterator pos, list&& other, const_iterator it);
+        // Linear in the length of the range unless other is *this.
+        void splice(const_iterator pos, list& other, const_iterator first, const_iterator last);
+        void splice(const_iterator pos, list&& other, const_iterator first, const_iterator last);
         void remove(const T& value);
+        template <class UnaryPredicate>
+        void remove_if(UnaryPredicate pred);
         void reverse();
         void unique();
+        template <class BinaryPredicate>
+        void unique(BinaryPredicate pred);
+        // Stable merge sort that relinks nodes in place without allocating.
         void sort();
+        template <class Compare>
+        void sort(Compare comp);
+
+      private:
+        // Moves [first, last) in front of pos; sizes are up to the caller.
+        static void transfer(Link* pos, Link* first, Link* last);
+        // Unlinks and frees node.
+        void destroy(Link* link);
+        // Takes over other's nodes; this must be empty.
+        void steal(list& other) noexcept;
+
+        // A run of nodes linked both ways, last->next being null.
+        struct Chain {
+            Link *first;
+            Link *last;
+        };
+
+        // Merges two sorted non-empty chains, taking from first on ties.
+        template <class Compare>
+        static Chain merge_chains(Chain first, Chain second, Compare& comp);
     };
 
     template <class T, class Alloc>
@@ -176,12 +230,12 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator::reference list<T, Alloc>::iterator::operator*() const {
-        return cur->data;
+        return value(cur);
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator::pointer list<T, Alloc>::iterator::operator->() const {
-        return &(cur->data);
+        return &value(cur);
     }
 
     template <class T, class Alloc>
@@ -243,12 +297,12 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::const_iterator::reference list<T, Alloc>::const_iterator::operator*() const {
-        return cur->data;
+        return value(cur);
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::const_iterator::pointer list<T, Alloc>::const_iterator::operator->() const {
-        return &(cur->data);
+        return &value(cur);
     }
 
     template <class T, class Alloc>
@@ -259,7 +313,7 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::const_iterator list<T, Alloc>::const_iterator::operator--(int) {
-        iterator it = *this;
+        const_iterator it = *this;
         cur = cur->prev;
         return it;
     }
@@ -275,18 +329,13 @@ namespace task {
     }
 
     template <class T, class Alloc>
-    list<T, Alloc>::list() : size_(0) {
-        head = allocator.allocate(1);
-        tail = allocator.allocate(1);
-        head->prev = nullptr;
-        head->next = tail;
-        tail->prev = head;
-        tail->next = nullptr;
+    list<T, Alloc>::list() noexcept : size_(0) {
+        sentinel.next = sentinel.prev = &sentinel;
     }
 
     template <class T, class Alloc>
-    list<T, Alloc>::list(const Alloc& alloc) : list<T, Alloc>() {
-        allocator = alloc;
+    list<T, Alloc>::list(const Alloc& alloc) noexcept : allocator(alloc), size_(0) {
+        sentinel.next = sentinel.prev = &sentinel;
     }
 
     template <class T, class Alloc>
@@ -304,8 +353,6 @@ namespace task {
     template <class T, class Alloc>
     list<T, Alloc>::~list() {
         clear();
-        allocator.deallocate(head, 1);
-        allocator.deallocate(tail, 1);
     }
 
     template <class T, class Alloc>
@@ -316,15 +363,8 @@ namespace task {
     }
 
     template <class T, class Alloc>
-    list<T, Alloc>::list(list&& other) : list<T, Alloc>() {
-        head->next = other.head->next;
-        head->next->prev = head;
-        tail->prev = other.tail->prev;
-        tail->prev->next = tail;
-        size_ = other.size_;
-        other.head->next = other.tail;
-        other.tail->prev = other.head;
-        other.size_ = 0;
+    list<T, Alloc>::list(list&& other) noexcept : list<T, Alloc>(other.get_allocator()) {
+        steal(other);
     }
 
     template <class T, class Alloc>
@@ -337,19 +377,26 @@ namespace task {
     }
 
     template <class T, class Alloc>
-    list<T, Alloc>& list<T, Alloc>::operator=(list&& other) {
-        clear();
-        head->next = other.head->next;
-        head->next->prev = head;
-        tail->prev = other.tail->prev;
-        tail->prev->next = tail;
-        size_ = other.size_;
-        other.head->next = other.tail;
-        other.tail->prev = other.head;
-        other.size_ = 0;
+    list<T, Alloc>& list<T, Alloc>::operator=(list&& other) noexcept {
+        if (this != &other) {
+            clear();
+            steal(other);
+        }
         return *this;
     }
 
+    template <class T, class Alloc>
+    void list<T, Alloc>::steal(list& other) noexcept {
+        if (!other.empty()) {
+            sentinel.next = other.sentinel.next;
+            sentinel.prev = other.sentinel.prev;
+            sentinel.next->prev = sentinel.prev->next = &sentinel;
+            size_ = other.size_;
+            other.sentinel.next = other.sentinel.prev = &other.sentinel;
+            other.size_ = 0;
+        }
+    }
+
     template <class T, class Alloc>
     Alloc list<T, Alloc>::get_allocator() const {
         return allocator;
@@ -357,63 +404,61 @@ namespace task {
 
     template <class T, class Alloc>
     T& list<T, Alloc>::front() {
-        return head->next->data;
+        return value(sentinel.next);
     }
 
     template <class T, class Alloc>
     const T& list<T, Alloc>::front() const {
-        return head->next->data;
+        return value(sentinel.next);
     }
 
     template <class T, class Alloc>
     T& list<T, Alloc>::back() {
-        return tail->prev->data;
+        return value(sentinel.prev);
     }
 
     template <class T, class Alloc>
     const T& list<T, Alloc>::back() const {
-        return tail->prev->data;
+        return value(sentinel.prev);
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator list<T, Alloc>::begin() {
         iterator it;
-        it.cur = head->next;
+        it.cur = sentinel.next;
         return it;
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator list<T, Alloc>::end() {
         iterator it;
-        it.cur = tail;
+        it.cur = &sentinel;
         return it;
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::const_iterator list<T, Alloc>::cbegin() const {
         const_iterator it;
-        it.cur = head->next;
+        it.cur = sentinel.next;
         return it;
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::const_iterator list<T, Alloc>::cend() const {
         const_iterator it;
-        it.cur = tail;
+        it.cur = &sentinel;
         return it;
     }
 
     template <class T, class Alloc>
     typename task::list<T, Alloc>::reverse_iterator list<T, Alloc>::rbegin() {
-        reverse_iterator it;
-        it.ptr = tail->prev;
+        reverse_iterator it(end());
         return it;
     }
 
     template <class T, class Alloc>
     typename list<T, Alloc>::reverse_iterator list<T, Alloc>::rend() {
-        reverse_iterator it;
-        it.ptr = head;
+        reverse_iterator it(begin());
         return it;
     }
 
@@ -441,7 +486,7 @@ namespace task {
 
     template <class T, class Alloc>
     size_t list<T, Alloc>::max_size() const {
-        return allocator.max_size();
+        return node_traits::max_size(allocator);
     }
 
     template <class T, class Alloc>
@@ -454,9 +499,9 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos, const T& value) {
-        Node *prev = pos.cur->prev;
+        Link *prev = pos.cur->prev;
         Node *node = allocator.allocate(1);
-        allocator.construct(node, value, prev->next, prev);
+        node_traits::construct(allocator, node, prev->next, prev, value);
         prev->next->prev = node;
         prev->next = node;
         iterator it;
@@ -467,9 +512,9 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator list<T, Alloc>::insert(const_iterator pos, T&& value) {
-        Node *prev = pos.cur->prev;
+        Link *prev = pos.cur->prev;
         Node *node = allocator.allocate(1);
-        allocator.construct(node, std::move(value), prev->next, prev);
+        node_traits::construct(allocator, node, prev->next, prev, std::move(value));
         prev->next->prev = node;
         prev->next = node;
         iterator it;
@@ -489,14 +534,14 @@ namespace task {
 
     template <class T, class Alloc>
     typename list<T, Alloc>::iterator list<T, Alloc>::erase(const_iterator pos) {
-        Node *to_del = const_cast<Node*>(pos.cur);
+        Link *to_del = const_cast<Link*>(pos.cur);
         iterator it;
         it.cur = to_del->next;
         it.cur->prev = to_del->prev;
         to_del->prev->next = to_del->next;
         --size_;
-        allocator.destroy(to_del);
-        allocator.deallocate(to_del, 1);
+        node_traits::destroy(allocator, static_cast<Node*>(to_del));
+        allocator.deallocate(static_cast<Node*>(to_del), 1);
         return it;
     }
 
@@ -507,33 +552,33 @@ namespace task {
             c_it = erase(c_it);
         }
         iterator it;
-        it.cur = const_cast<Node*>(c_it.cur);
+        it.cur = const_cast<Link*>(c_it.cur);
         return it;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::push_back(const T& value) {
         Node *node = allocator.allocate(1);
-        allocator.construct(node, value, tail, tail->prev);
-        tail->prev = tail->prev->next = node;
+        node_traits::construct(allocator, node, &sentinel, sentinel.prev, value);
+        sentinel.prev = sentinel.prev->next = node;
         ++size_;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::push_back(T&& value) {
         Node *node = allocator.allocate(1);
-        allocator.construct(node, std::move(value), tail, tail->prev);
-        tail->prev = tail->prev->next = node;
+        node_traits::construct(allocator, node, &sentinel, sentinel.prev, std::move(value));
+        sentinel.prev = sentinel.prev->next = node;
         ++size_;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::pop_back() {
         if (!empty()) {
-            Node *node = tail->prev;
+            Node *node = static_cast<Node*>(sentinel.prev);
             node->prev->next = node->next;
             node->next->prev = node->prev;
-            allocator.destroy(node);
+            node_traits::destroy(allocator, node);
             allocator.deallocate(node, 1);
             --size_;
         }
@@ -542,26 +587,26 @@ namespace task {
     template <class T, class Alloc>
     void list<T, Alloc>::push_front(const T& value) {
         Node *node = allocator.allocate(1);
-        allocator.construct(node, value, head->next, head);
-        head->next = head->next->prev = node;
+        node_traits::construct(allocator, node, sentinel.next, &sentinel, value);
+        sentinel.next = sentinel.next->prev = node;
         ++size_;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::push_front(T&& value) {
         Node *node = allocator.allocate(1);
-        allocator.construct(node, std::move(value), head->next, head);
-        head->next = head->next->prev = node;
+        node_traits::construct(allocator, node, sentinel.next, &sentinel, std::move(value));
+        sentinel.next = sentinel.next->prev = node;
         ++size_;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::pop_front() {
         if (!empty()) {
-            Node *node = head->next;
+            Node *node = static_cast<Node*>(sentinel.next);
             node->prev->next = node->next;
             node->next->prev = node->prev;
-            allocator.destroy(node);
+            node_traits::destroy(allocator, node);
             allocator.deallocate(node, 1);
             --size_;
         }
@@ -570,18 +615,13 @@ namespace task {
     template <class T, class Alloc>
     template <class... Args>
     typename list<T, Alloc>::iterator list<T, Alloc>::emplace(typename list<T, Alloc>::const_iterator pos, Args&&... args) {
-        Node *prev = pos.cur->prev;
-        Alloc data_allocator;
+        Link *prev = pos.cur->prev;
         Node *node = allocator.allocate(1);
-        T *data = data_allocator.allocate(1);
-        data_allocator.construct(data, std::forward<Args>(args)...);
-        allocator.construct(node, std::move(*data), prev->next, prev);
-        data_allocator.destroy(data);
-        data_allocator.deallocate(data, 1);
+        node_traits::construct(allocator, node, prev->next, prev, std::forward<Args>(args)...);
         prev->next->prev = node;
         prev->next = node;
         iterator it;
-        it.cur = pos.cur->prev;
+        it.cur = node;
         ++size_;
         return it;
     }
@@ -602,8 +642,8 @@ namespace task {
     void list<T, Alloc>::resize(size_t count) {
         while (size_ < count) {
             Node *node = allocator.allocate(1);
-            allocator.construct(node, tail, tail->prev);
-            tail->prev = tail->prev->next = node;
+            node_traits::construct(allocator, node, &sentinel, sentinel.prev);
+            sentinel.prev = sentinel.prev->next = node;
             ++size_;
         }
         while (size_ > count) {
@@ -613,135 +653,264 @@ namespace task {
 
     template <class T, class Alloc>
     void list<T, Alloc>::swap(list& other) {
-        Node *node = head;
-        head = other.head;
-        other.head = node;
-        node = other.tail;
-        other.tail = tail;
-        tail = node;
-        size_t s = size_;
-        size_ = other.size_;
-        other.size_ = s;
+        list temp(std::move(other));
+        other.steal(*this);
+        steal(temp);
+        std::swap(allocator, other.allocator);
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::merge(list& other) {
-        if (!other.empty()) {
-            Node *node = other.head->next;
-            Node *current = head->next;
-            while (node != other.tail) {
-                while (current != tail && node->data > current->data) {
-                    current = current->next;
+        merge(other, std::less<>());
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::merge(list&& other) {
+        merge(other, std::less<>());
+    }
+
+    template <class T, class Alloc>
+    template <class Compare>
+    void list<T, Alloc>::merge(list& other, Compare comp) {
+        if (this == &other) {
+            return;
+        }
+        Link *current = sentinel.next;
+        Link *node = other.sentinel.next;
+        while (node != &other.sentinel) {
+            if (current == &sentinel) {
+                transfer(&sentinel, node, &other.sentinel);
+                break;
+            }
+            if (comp(value(node), value(current))) {
+                // Move the whole run of other's nodes that go here at once.
+                Link *last = node->next;
+                while (last != &other.sentinel && comp(value(last), value(current))) {
+                    last = last->next;
                 }
-                Node *next = node->next;
-                node->prev = current->prev;
-                node->next = current;
-                current->prev->next = node;
-                current->prev = node;
-                node = next;
+                transfer(current, node, last);
+                node = last;
             }
-            other.head->next = other.tail;
-            other.tail->prev = other.head;
-            size_ += other.size_;
-            other.size_ = 0;
+            current = current->next;
+        }
+        size_ += other.size_;
+        other.size_ = 0;
+    }
+
+    template <class T, class Alloc>
+    template <class Compare>
+    void list<T, Alloc>::merge(list&& other, Compare comp) {
+        merge(other, comp);
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::transfer(Link* pos, Link* first, Link* last) {
+        if (first == last) {
+            return;
         }
+        Link *back = last->prev;
+        first->prev->next = last;
+        last->prev = first->prev;
+        first->prev = pos->prev;
+        pos->prev->next = first;
+        back->next = pos;
+        pos->prev = back;
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::destroy(Link* link) {
+        link->prev->next = link->next;
+        link->next->prev = link->prev;
+        Node *node = static_cast<Node*>(link);
+        node_traits::destroy(allocator, node);
+        allocator.deallocate(node, 1);
+        --size_;
     }
 
     template <class T, class Alloc>
     void list<T, Alloc>::splice(const_iterator pos, list& other) {
-        if (!other.empty()) {
-            Node *node = const_cast<Node*>(pos.cur);
-            node->prev->next = other.head->next;
-            other.head->next->prev = node->prev;
-            node->prev = other.tail->prev;
-            other.tail->prev->next = node;
-            other.head->next = other.tail;
-            other.tail->prev = other.head;
+        if (this != &other) {
+            transfer(const_cast<Link*>(pos.cur), other.sentinel.next, &other.sentinel);
             size_ += other.size_;
             other.size_ = 0;
         }
     }
 
     template <class T, class Alloc>
-    void task::list<T, Alloc>::remove(const T& value) {
-        list<iterator> to_del;
-        iterator it = begin();
+    void list<T, Alloc>::splice(const_iterator pos, list&& other) {
+        splice(pos, other);
+    }
 
-        while (it != end()) {
-            if (*it == value) {
-                to_del.push_back(it);
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list& other, const_iterator it) {
+        // Splicing an element in front of itself or of its successor is a
+        // no-op, and transfer would link the node to itself.
+        if (pos.cur == it.cur || pos.cur == it.cur->next) {
+            return;
+        }
+        Link *node = const_cast<Link*>(it.cur);
+        transfer(const_cast<Link*>(pos.cur), node, node->next);
+        --other.size_;
+        ++size_;
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list&& other, const_iterator it) {
+        splice(pos, other, it);
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list& other, const_iterator first, const_iterator last) {
+        if (this != &other) {
+            const size_t count = std::distance(first, last);
+            other.size_ -= count;
+            size_ += count;
+        }
+        transfer(const_cast<Link*>(pos.cur), const_cast<Link*>(first.cur), const_cast<Link*>(last.cur));
+    }
+
+    template <class T, class Alloc>
+    void list<T, Alloc>::splice(const_iterator pos, list&& other, const_iterator first, const_iterator last) {
+        splice(pos, other, first, last);
+    }
+
+    template <class T, class Alloc>
+    void task::list<T, Alloc>::remove(const T& value) {
+        // value may be one of the elements; that node goes last.
+        Link *self = nullptr;
+        Link *node = sentinel.next;
+        while (node != &sentinel) {
+            Link *next = node->next;
+            if (list::value(node) == value) {
+                if (&list::value(node) == &value) {
+                    self = node;
+                } else {
+                    destroy(node);
+                }
             }
-            ++it;
+            node = next;
         }
-        for (auto it = to_del.begin(); it != to_del.end(); ++it) {
-            erase(*it);
+        if (self != nullptr) {
+            destroy(self);
         }
     }
 
     template <class T, class Alloc>
-    void task::list<T, Alloc>::reverse() {
-        Node *node = head->next;
-        while (node != tail) {
-            Node *next = node->next;
-            node->next = node->prev;
-            node->prev = next;
+    template <class UnaryPredicate>
+    void task::list<T, Alloc>::remove_if(UnaryPredicate pred) {
+        Link *node = sentinel.next;
+        while (node != &sentinel) {
+            Link *next = node->next;
+            if (pred(value(node))) {
+                destroy(node);
+            }
             node = next;
         }
-        head->prev = head->next;
-        head->next = nullptr;
-        tail->next = tail->prev;
-        tail->prev = nullptr;
-        node = head;
-        head = tail;
-        tail = node;
+    }
+
+    template <class T, class Alloc>
+    void task::list<T, Alloc>::reverse() {
+        Link *link = &sentinel;
+        do {
+            std::swap(link->next, link->prev);
+            link = link->prev;
+        } while (link != &sentinel);
     }
 
     template <class T, class Alloc>
     void task::list<T, Alloc>::unique() {
-        iterator it = begin();
-        while (it != --end()) {
-            if (*it == *(++it)) {
-                it = erase(it);
-                --it;
+        unique(std::equal_to<>());
+    }
+
+    template <class T, class Alloc>
+    template <class BinaryPredicate>
+    void task::list<T, Alloc>::unique(BinaryPredicate pred) {
+        if (empty()) {
+            return;
+        }
+        // Every element is compared with the first of its group.
+        Link *node = sentinel.next;
+        while (node->next != &sentinel) {
+            if (pred(value(node), value(node->next))) {
+                destroy(node->next);
+            } else {
+                node = node->next;
             }
         }
     }
 
     template <class T, class Alloc>
     void task::list<T, Alloc>::sort() {
-        if (size_ > 1) {
-            list left, right;
-            Node *l_node = left.head, *r_node = right.head;
-            Node *node = head->next;
-            int count = 0;
-            while (count < size_) {
-                if (count < size_/2) {
-                    l_node->next = node;
-                    node->prev = l_node;
-                    l_node = l_node->next;
-                    left.size_++;
-                }
-                else {
-                    r_node->next = node;
-                    node->prev = r_node;
-                    r_node = r_node->next;
-                    right.size_++;
-                }
-                node = node->next;
-                count++;
+        sort(std::less<>());
+    }
+
+    template <class T, class Alloc>
+    template <class Compare>
+    void task::list<T, Alloc>::sort(Compare comp) {
+        if (size_ < 2) {
+            return;
+        }
+        // Bottom up: runs[i] is empty or a sorted chain of 2^i nodes, all
+        // of which came before those in runs[i - 1]. Each node enters as a
+        // chain of one and carries up like a binary counter increment.
+        Chain runs[64] = {};
+        Link *node = sentinel.next;
+        sentinel.prev->next = nullptr;
+        while (node != nullptr) {
+            Chain run{node, node};
+            node = node->next;
+            run.last->next = nullptr;
+            size_t i = 0;
+            for (; runs[i].first != nullptr; ++i) {
+                run = merge_chains(runs[i], run, comp);
+                runs[i].first = nullptr;
+            }
+            runs[i] = run;
+        }
+        Chain sorted{nullptr, nullptr};
+        for (const Chain& run : runs) {
+            if (run.first != nullptr) {
+                sorted = sorted.first == nullptr ? run : merge_chains(run, sorted, comp);
             }
-            left.tail->prev = l_node;
-            l_node->next = left.tail;
-            right.tail->prev = r_node;
-            r_node->next = right.tail;
-            head->next = tail;
-            tail->prev = head;
-            size_ = 0;
-            left.sort();
-            right.sort();
-            left.merge(right);
-            (*this) = left;
         }
+        sentinel.next = sorted.first;
+        sorted.first->prev = &sentinel;
+        sorted.last->next = &sentinel;
+        sentinel.prev = sorted.last;
+    }
+
+    template <class T, class Alloc>
+    template <class Compare>
+    typename list<T, Alloc>::Chain list<T, Alloc>::merge_chains(Chain first, Chain second, Compare& comp) {
+        // Links only change where the merge switches chains. Leaving the
+        // other nodes alone keeps their cache lines clean, and keeps prev
+        // right without a separate pass over the result.
+        Link *left = first.first, *right = second.first;
+        Chain result{nullptr, nullptr};
+        while (left != nullptr && right != nullptr) {
+            Link *&source = comp(value(right), value(left)) ? right : left;
+            if (result.first == nullptr) {
+                result.first = source;
+            } else if (result.last->next != source) {
+                result.last->next = source;
+                source->prev = result.last;
+            }
+            result.last = source;
+            source = source->next;
+        }
+        Link *rest = left != nullptr ? left : right;
+        if (result.last->next != rest) {
+            result.last->next = rest;
+            rest->prev = result.last;
+        }
+        result.last = left != nullptr ? first.last : second.last;
+        return result;
     }
 
+
+    // list whose nodes come from a per-thread pool instead of one operator
+    // new each, see pool_allocator.h.
+    template <class T>
+    using pooled_list = list<T, pool_allocator<T>>;
+
 }  // namespace task
@@ -0,0 +1,191 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+
+namespace task {
+
+    namespace detail {
+
+        // Blocks of one size and alignment, handed out from a free list of
+        // released blocks or else carved in address order from the newest
+        // slab; slabs double in size up to max_slab_bytes. Every thread has
+        // its own pool, so nothing here locks except adopting a pool.
+        //
+        // Slabs are never returned to the system: a block may be released
+        // by another thread, or after its thread exited. When a thread
+        // exits, its pool (free list and all) waits to be adopted by the
+        // next thread that needs one, so memory stays bounded by the peak
+        // in use at any one time.
+        template <size_t Size, size_t Align>
+        class node_pool {
+            struct free_block {
+                free_block* next;
+            };
+
+          public:
+            // Blocks are big enough to hold a free-list link when released;
+            // pool_allocator sizes its operator new fallback the same way.
+            static constexpr size_t alignment = std::max(Align, alignof(free_block));
+            static constexpr size_t block_size =
+                (std::max(Size, sizeof(free_block)) + alignment - 1) / alignment * alignment;
+            static constexpr size_t first_slab_bytes = 4096;
+            static constexpr size_t max_slab_bytes = 1 << 20;
+
+            // The calling thread's pool; nullptr while the thread is being
+            // torn down, when callers fall back to operator new.
+            static node_pool* local();
+
+            void* allocate();
+            void deallocate(void* block) noexcept;
+
+          private:
+            struct holder;
+            static std::vector<node_pool*>& orphans();
+            static std::mutex& orphans_mutex();
+
+            free_block* free_ = nullptr;
+            char* cursor_ = nullptr;
+            char* end_ = nullptr;
+            size_t slab_bytes_ = first_slab_bytes;
+        };
+
+        // Owns the calling thread's pool and hands it on at thread exit.
+        template <size_t Size, size_t Align>
+        struct node_pool<Size, Align>::holder {
+            enum class state : unsigned char { unused, alive, destroyed };
+            static inline thread_local state status = state::unused;
+
+            node_pool* pool;
+
+            holder() {
+                std::lock_guard<std::mutex> lock(orphans_mutex());
+                if (orphans().empty()) {
+                    pool = new node_pool();
+                } else {
+                    pool = orphans().back();
+                    orphans().pop_back();
+                }
+                status = state::alive;
+            }
+
+            ~holder() {
+                status = state::destroyed;
+                std::lock_guard<std::mutex> lock(orphans_mutex());
+                orphans().push_back(pool);
+            }
+        };
+
+        template <size_t Size, size_t Align>
+        std::vector<node_pool<Size, Align>*>& node_pool<Size, Align>::orphans() {
+            // Never destroyed, so threads exiting after static destruction
+            // still find it.
+            static auto* pools = new std::vector<node_pool*>();
+            return *pools;
+        }
+
+        template <size_t Size, size_t Align>
+        std::mutex& node_pool<Size, Align>::orphans_mutex() {
+            static auto* mutex = new std::mutex();
+            return *mutex;
+        }
+
+        template <size_t Size, size_t Align>
+        node_pool<Size, Align>* node_pool<Size, Align>::local() {
+            if (holder::status == holder::state::destroyed) {
+                return nullptr;
+            }
+            thread_local holder current;
+            return current.pool;
+        }
+
+        template <size_t Size, size_t Align>
+        void* node_pool<Size, Align>::allocate() {
+            if (free_ != nullptr) {
+                free_block* block = free_;
+                free_ = block->next;
+                return block;
+            }
+            if (cursor_ == end_) {
+                const size_t bytes = std::max(slab_bytes_, block_size);
+                cursor_ = static_cast<char*>(::operator new(bytes, std::align_val_t(alignment)));
+                end_ = cursor_ + bytes / block_size * block_size;
+                slab_bytes_ = std::min(slab_bytes_ * 2, max_slab_bytes);
+            }
+            void* block = cursor_;
+            cursor_ += block_size;
+            return block;
+        }
+
+        template <size_t Size, size_t Align>
+        void node_pool<Size, Align>::deallocate(void* block) noexcept {
+            free_block* node = static_cast<free_block*>(block);
+            node->next = free_;
+            free_ = node;
+        }
+
+    }  // namespace detail
+
+
+    // Stateless allocator serving single objects from a per-thread node
+    // pool (see detail::node_pool) and everything else from operator new.
+    // Meant for node-based containers, which allocate one node at a time:
+    // erased nodes are recycled without a trip to malloc, and consecutive
+    // nodes sit next to each other in memory. All instances compare equal,
+    // so containers using it can splice and swap freely.
+    template <class T>
+    class pool_allocator {
+      public:
+        using value_type = T;
+        using is_always_equal = std::true_type;
+
+        pool_allocator() noexcept = default;
+        template <class U>
+        pool_allocator(const pool_allocator<U>&) noexcept {}
+
+        T* allocate(size_t count);
+        void deallocate(T* pointer, size_t count) noexcept;
+
+      private:
+        using pool = detail::node_pool<sizeof(T), alignof(T)>;
+    };
+
+    template <class T>
+    T* pool_allocator<T>::allocate(size_t count) {
+        if (count == 1) {
+            if (pool* local = pool::local()) {
+                return static_cast<T*>(local->allocate());
+            }
+        }
+        const size_t bytes = std::max(count * sizeof(T), pool::block_size);
+        return static_cast<T*>(::operator new(bytes, std::align_val_t(pool::alignment)));
+    }
+
+    template <class T>
+    void pool_allocator<T>::deallocate(T* pointer, size_t count) noexcept {
+        if (count != 1) {
+            ::operator delete(pointer, std::align_val_t(pool::alignment));
+            return;
+        }
+        // With the thread's pool gone the block stays where it is, a slab
+        // (or an operator new block) that lives until the process exits.
+        if (pool* local = pool::local()) {
+            local->deallocate(pointer);
+        }
+    }
+
+    template <class T, class U>
+    bool operator==(const pool_allocator<T>&, const pool_allocator<U>&) {
+        return true;
+    }
+
+    template <class T, class U>
+    bool operator!=(const pool_allocator<T>&, const pool_allocator<U>&) {
+        return false;
+    }
+
+}  // namespace task
@@ -0,0 +1,822 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace task {
+
+    // Elements per node of unrolled_list<T> by default: about 256 bytes
+    // of them, and at least 4.
+    template <class T>
+    constexpr size_t unrolled_node_capacity() {
+        return std::max<size_t>(4, 256 / sizeof(T));
+    }
+
+    // A list with the interface of task::list whose nodes each hold up to
+    // Capacity elements in an inline array, so for small T iteration walks
+    // contiguous memory and the two link pointers are paid per node rather
+    // than per element. A full node splits in half on insert; a node that
+    // runs low on erase merges with a neighbour.
+    //
+    // T must be move constructible. Iterators are a node and an index in
+    // it, so they are less stable than task::list's:
+    //  - insert and emplace invalidate iterators to the elements after the
+    //    insertion point in the same node; if that node splits, also those
+    //    to the elements that moved to the new node. push_back and
+    //    push_front only do so when the node at that end is full.
+    //  - erase invalidates iterators to the elements after the erased one
+    //    in its node, and to all elements of a node merged into another.
+    //  - splice keeps iterators into the other list valid (its nodes are
+    //    relinked) but invalidates those after pos in pos's node.
+    //  - remove, unique, reverse, sort and merge move elements between
+    //    positions: iterators stay attached to positions, not elements,
+    //    and those past the new end are invalidated.
+    //  - end() is never invalidated, except by swap and move.
+    template <class T, class Alloc = std::allocator<T>, size_t Capacity = unrolled_node_capacity<T>()>
+    class unrolled_list {
+        static_assert(Capacity >= 2, "unrolled_list nodes need room for at least two elements");
+
+      private:
+        struct Link {
+            Link *next;
+            Link *prev;
+        };
+
+        struct Node : Link {
+            size_t count;
+            alignas(T) unsigned char storage[Capacity * sizeof(T)];
+
+            Node() : count(0) {}
+
+            T* slot(size_t index) {
+                return reinterpret_cast<T*>(storage + index * sizeof(T));
+            }
+            T& item(size_t index) {
+                return *std::launder(slot(index));
+            }
+        };
+
+        using allocator_type = typename std::allocator_traits<Alloc>::template rebind_alloc<Node>;
+        using node_traits = std::allocator_traits<allocator_type>;
+        allocator_type allocator;
+        // next is the first node and prev the last; both point back at the
+        // sentinel itself when the list is empty.
+        Link sentinel;
+        size_t size_;
+
+        static Node* node(Link* link) {
+            return static_cast<Node*>(link);
+        }
+        static const Node* node(const Link* link) {
+            return static_cast<const Node*>(link);
+        }
+
+      public:
+        class iterator {
+          public:
+            using difference_type = ptrdiff_t;
+            using value_type = T;
+            using pointer = T*;
+            using reference = T&;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            iterator() : link(nullptr), index(0) {}
+
+            reference operator*() const {
+                return node(link)->item(index);
+            }
+            pointer operator->() const {
+                return &node(link)->item(index);
+            }
+            iterator& operator++() {
+                if (++index == node(link)->count) {
+                    link = link->next;
+                    index = 0;
+                }
+                return *this;
+            }
+            iterator operator++(int) {
+                iterator it = *this;
+                ++*this;
+                return it;
+            }
+            iterator& operator--() {
+                if (index == 0) {
+                    link = link->prev;
+                    index = node(link)->count;
+                }
+                --index;
+                return *this;
+            }
+            iterator operator--(int) {
+                iterator it = *this;
+                --*this;
+                return it;
+            }
+            bool operator==(iterator other) const {
+                return link == other.link && index == other.index;
+            }
+            bool operator!=(iterator other) const {
+                return !(*this == other);
+            }
+            friend class unrolled_list;
+
+          private:
+            iterator(Link* l, size_t i) : link(l), index(i) {}
+
+            Link *link;
+            size_t index;
+        };
+
+
+        class const_iterator {
+          public:
+            using difference_type = ptrdiff_t;
+            using value_type = T;
+            using pointer = const T*;
+            using reference = const T&;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            const_iterator() : link(nullptr), index(0) {}
+            const_iterator(const iterator& other) : link(other.link), index(other.index) {}
+
+            reference operator*() const {
+                return const_cast<Node*>(node(link))->item(index);
+            }
+            pointer operator->() const {
+                return &**this;
+            }
+            const_iterator& operator++() {
+                if (++index == node(link)->count) {
+                    link = link->next;
+                    index = 0;
+                }
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator it = *this;
+                ++*this;
+                return it;
+            }
+            const_iterator& operator--() {
+                if (index == 0) {
+                    link = link->prev;
+                    index = node(link)->count;
+                }
+                --index;
+                return *this;
+            }
+            const_iterator operator--(int) {
+                const_iterator it = *this;
+                --*this;
+                return it;
+            }
+            bool operator==(const_iterator other) const {
+                return link == other.link && index == other.index;
+            }
+            bool operator!=(const_iterator other) const {
+                return !(*this == other);
+            }
+            friend class unrolled_list;
+
+          private:
+            const_iterator(const Link* l, size_t i) : link(l), index(i) {}
+
+            const Link *link;
+            size_t index;
+        };
+
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+        unrolled_list() noexcept;
+        explicit unrolled_list(const Alloc& alloc) noexcept;
+        unrolled_list(size_t count, const T& value, const Alloc& alloc = Alloc());
+        explicit unrolled_list(size_t count, const Alloc& alloc = Alloc());
+
+        ~unrolled_list();
+
+        unrolled_list(const unrolled_list& other);
+        unrolled_list(unrolled_list&& other) noexcept;
+
+        unrolled_list& operator=(const unrolled_list& other);
+        unrolled_list& operator=(unrolled_list&& other) noexcept;
+
+        Alloc get_allocator() const;
+
+        T& front();
+        const T& front() const;
+
+        T& back();
+        const T& back() const;
+
+        iterator begin();
+        iterator end();
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        const_iterator cbegin() const;
+        const_iterator cend() const;
+
+        reverse_iterator rbegin();
+        reverse_iterator rend();
+
+        const_reverse_iterator crbegin() const;
+        const_reverse_iterator crend() const;
+
+        bool empty() const;
+        size_t size() const;
+        size_t max_size() const;
+        void clear();
+
+        iterator insert(const_iterator pos, const T& value);
+        iterator insert(const_iterator pos, T&& value);
+        iterator insert(const_iterator pos, size_t count, const T& value);
+
+        iterator erase(const_iterator pos);
+        iterator erase(const_iterator first, const_iterator last);
+
+        void push_back(const T& value);
+        void push_back(T&& value);
+        void pop_back();
+        void push_front(const T& value);
+        void push_front(T&& value);
+        void pop_front();
+
+        template <class... Args>
+        iterator emplace(const_iterator pos, Args&&... args);
+        template <class... Args>
+        void emplace_back(Args&&... args);
+        template <class... Args>
+        void emplace_front(Args&&... args);
+        void resize(size_t count);
+        void swap(unrolled_list& other);
+        // Unlike task::list, merge and sort move elements instead of
+        // relinking them, through a temporary buffer.
+        void merge(unrolled_list& other);
+        void splice(const_iterator pos, unrolled_list& other);
+        void remove(const T& value);
+        void reverse();
+        void unique();
+        void sort();
+
+      private:
+        Node* create_node(Link* before);
+        void destroy_node(Node* node);
+        // Moves the elements [first, last) of from to to, starting at
+        // index dest; the ranges may overlap within one node.
+        static void relocate(Node* from, size_t first, size_t last, Node* to, size_t dest);
+        // Moves the elements [index, count) of node into a new node after it.
+        Node* split(Node* node, size_t index);
+        iterator insert_value(const_iterator pos, T&& value);
+        void steal(unrolled_list& other) noexcept;
+        iterator truncate(iterator first);
+    };
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list() noexcept : size_(0) {
+        sentinel.next = sentinel.prev = &sentinel;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list(const Alloc& alloc) noexcept
+        : allocator(alloc), size_(0) {
+        sentinel.next = sentinel.prev = &sentinel;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list(size_t count, const T& value, const Alloc& alloc)
+        : unrolled_list(alloc) {
+        while (size_ < count) {
+            push_back(value);
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list(size_t count, const Alloc& alloc) : unrolled_list(alloc) {
+        resize(count);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::~unrolled_list() {
+        clear();
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list(const unrolled_list& other)
+        : unrolled_list(other.get_allocator()) {
+        for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+            push_back(*it);
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>::unrolled_list(unrolled_list&& other) noexcept
+        : unrolled_list(other.get_allocator()) {
+        steal(other);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>& unrolled_list<T, Alloc, Capacity>::operator=(const unrolled_list& other) {
+        if (this != &other) {
+            clear();
+            for (const_iterator it = other.cbegin(); it != other.cend(); ++it) {
+                push_back(*it);
+            }
+        }
+        return *this;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    unrolled_list<T, Alloc, Capacity>& unrolled_list<T, Alloc, Capacity>::operator=(unrolled_list&& other) noexcept {
+        if (this != &other) {
+            clear();
+            steal(other);
+        }
+        return *this;
+    }
+
+    // Takes over other's nodes; this must be empty.
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::steal(unrolled_list& other) noexcept {
+        if (other.empty()) {
+            return;
+        }
+        sentinel.next = other.sentinel.next;
+        sentinel.prev = other.sentinel.prev;
+        sentinel.next->prev = sentinel.prev->next = &sentinel;
+        size_ = other.size_;
+        other.sentinel.next = other.sentinel.prev = &other.sentinel;
+        other.size_ = 0;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    Alloc unrolled_list<T, Alloc, Capacity>::get_allocator() const {
+        return Alloc(allocator);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    T& unrolled_list<T, Alloc, Capacity>::front() {
+        return node(sentinel.next)->item(0);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    const T& unrolled_list<T, Alloc, Capacity>::front() const {
+        return *cbegin();
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    T& unrolled_list<T, Alloc, Capacity>::back() {
+        Node *last = node(sentinel.prev);
+        return last->item(last->count - 1);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    const T& unrolled_list<T, Alloc, Capacity>::back() const {
+        return *std::prev(cend());
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::begin() {
+        return iterator(sentinel.next, 0);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::end() {
+        return iterator(&sentinel, 0);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_iterator unrolled_list<T, Alloc, Capacity>::begin() const {
+        return cbegin();
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_iterator unrolled_list<T, Alloc, Capacity>::end() const {
+        return cend();
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_iterator unrolled_list<T, Alloc, Capacity>::cbegin() const {
+        return const_iterator(sentinel.next, 0);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_iterator unrolled_list<T, Alloc, Capacity>::cend() const {
+        return const_iterator(&sentinel, 0);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::reverse_iterator unrolled_list<T, Alloc, Capacity>::rbegin() {
+        return reverse_iterator(end());
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::reverse_iterator unrolled_list<T, Alloc, Capacity>::rend() {
+        return reverse_iterator(begin());
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_reverse_iterator unrolled_list<T, Alloc, Capacity>::crbegin() const {
+        return const_reverse_iterator(cend());
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::const_reverse_iterator unrolled_list<T, Alloc, Capacity>::crend() const {
+        return const_reverse_iterator(cbegin());
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    bool unrolled_list<T, Alloc, Capacity>::empty() const {
+        return size_ == 0;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    size_t unrolled_list<T, Alloc, Capacity>::size() const {
+        return size_;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    size_t unrolled_list<T, Alloc, Capacity>::max_size() const {
+        return node_traits::max_size(allocator) * Capacity;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::clear() {
+        while (sentinel.next != &sentinel) {
+            Node *first = node(sentinel.next);
+            for (size_t i = 0; i < first->count; ++i) {
+                first->item(i).~T();
+            }
+            destroy_node(first);
+        }
+        size_ = 0;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::Node* unrolled_list<T, Alloc, Capacity>::create_node(Link* before) {
+        Node *result = node_traits::allocate(allocator, 1);
+        node_traits::construct(allocator, result);
+        result->next = before;
+        result->prev = before->prev;
+        before->prev->next = result;
+        before->prev = result;
+        return result;
+    }
+
+    // Unlinks and frees a node whose elements are already gone.
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::destroy_node(Node* node) {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node_traits::destroy(allocator, node);
+        node_traits::deallocate(allocator, node, 1);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::relocate(Node* from, size_t first, size_t last, Node* to, size_t dest) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            std::memmove(to->slot(dest), from->slot(first), (last - first) * sizeof(T));
+        } else if (from != to || dest < first) {
+            for (size_t i = first; i < last; ++i) {
+                ::new (static_cast<void*>(to->slot(dest + i - first))) T(std::move(from->item(i)));
+                from->item(i).~T();
+            }
+        } else {
+            for (size_t i = last; i > first; --i) {
+                ::new (static_cast<void*>(to->slot(dest + i - 1 - first))) T(std::move(from->item(i - 1)));
+                from->item(i - 1).~T();
+            }
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::Node* unrolled_list<T, Alloc, Capacity>::split(Node* node, size_t index) {
+        Node *result = create_node(node->next);
+        relocate(node, index, node->count, result, 0);
+        result->count = node->count - index;
+        node->count = index;
+        return result;
+    }
+
+    // Every insertion ends up here, with the element already constructed,
+    // so the shifting below never has to undo anything.
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator
+    unrolled_list<T, Alloc, Capacity>::insert_value(const_iterator pos, T&& value) {
+        Link *link = const_cast<Link*>(pos.link);
+        size_t index = pos.index;
+        Node *target;
+        if (index == 0 && link->prev != &sentinel && node(link->prev)->count < Capacity) {
+            // Append to the previous node: nothing moves.
+            target = node(link->prev);
+            index = target->count;
+        } else if (link == &sentinel || (index == 0 && node(link)->count == Capacity)) {
+            // At the very end, or in front of a full node with a full (or
+            // no) node before it: start a new node.
+            target = create_node(link);
+            index = 0;
+        } else {
+            target = node(link);
+            if (target->count == Capacity) {
+                Node *upper = split(target, Capacity / 2);
+                if (index > Capacity / 2) {
+                    target = upper;
+                    index -= Capacity / 2;
+                }
+            }
+        }
+
+        relocate(target, index, target->count, target, index + 1);
+        ::new (static_cast<void*>(target->slot(index))) T(std::move(value));
+        ++target->count;
+        ++size_;
+        return iterator(target, index);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::insert(const_iterator pos, const T& value) {
+        return insert_value(pos, T(value));
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::insert(const_iterator pos, T&& value) {
+        return insert_value(pos, std::move(value));
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::insert(const_iterator pos, size_t count, const T& value) {
+        if (count == 0) {
+            return iterator(const_cast<Link*>(pos.link), pos.index);
+        }
+        // Each copy goes in front of the previous one, whose iterator is
+        // the only one known to be valid.
+        iterator it = insert(pos, value);
+        for (size_t i = 1; i < count; ++i) {
+            it = insert(it, value);
+        }
+        return it;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::erase(const_iterator pos) {
+        Node *target = node(const_cast<Link*>(pos.link));
+        size_t index = pos.index;
+        target->item(index).~T();
+        relocate(target, index + 1, target->count, target, index);
+        --target->count;
+        --size_;
+
+        if (target->count == 0) {
+            Link *next = target->next;
+            destroy_node(target);
+            return iterator(next, 0);
+        }
+        // Keep nodes at least about a quarter full: fold the next node into
+        // this one, or this one into the previous, when the pair fits in
+        // half a node.
+        if (target->next != &sentinel && target->count + node(target->next)->count <= Capacity / 2) {
+            Node *next = node(target->next);
+            relocate(next, 0, next->count, target, target->count);
+            target->count += next->count;
+            destroy_node(next);
+        } else if (target->prev != &sentinel && node(target->prev)->count + target->count <= Capacity / 2) {
+            Node *prev = node(target->prev);
+            relocate(target, 0, target->count, prev, prev->count);
+            index += prev->count;
+            prev->count += target->count;
+            destroy_node(target);
+            target = prev;
+        }
+        if (index == target->count) {
+            return iterator(target->next, 0);
+        }
+        return iterator(target, index);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::erase(const_iterator first, const_iterator last) {
+        // Erasing moves elements, so last cannot be compared against as
+        // we go; count instead.
+        size_t count = std::distance(first, last);
+        iterator it(const_cast<Link*>(first.link), first.index);
+        for (; count > 0; --count) {
+            it = erase(it);
+        }
+        return it;
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::push_back(const T& value) {
+        insert(cend(), value);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::push_back(T&& value) {
+        insert(cend(), std::move(value));
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::pop_back() {
+        if (!empty()) {
+            erase(std::prev(cend()));
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::push_front(const T& value) {
+        insert(cbegin(), value);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::push_front(T&& value) {
+        insert(cbegin(), std::move(value));
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::pop_front() {
+        if (!empty()) {
+            erase(cbegin());
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    template <class... Args>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::emplace(const_iterator pos, Args&&... args) {
+        return insert_value(pos, T(std::forward<Args>(args)...));
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    template <class... Args>
+    void unrolled_list<T, Alloc, Capacity>::emplace_back(Args&&... args) {
+        emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    template <class... Args>
+    void unrolled_list<T, Alloc, Capacity>::emplace_front(Args&&... args) {
+        emplace(cbegin(), std::forward<Args>(args)...);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::resize(size_t count) {
+        while (size_ < count) {
+            emplace_back();
+        }
+        while (size_ > count) {
+            pop_back();
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::swap(unrolled_list& other) {
+        unrolled_list temp(std::move(other));
+        other.steal(*this);
+        steal(temp);
+        std::swap(allocator, other.allocator);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::merge(unrolled_list& other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        std::vector<T> merged;
+        merged.reserve(size_ + other.size_);
+        iterator left = begin(), right = other.begin();
+        while (left != end() && right != other.end()) {
+            // Equal elements keep the ones from this list first.
+            if (*right < *left) {
+                merged.push_back(std::move(*right++));
+            } else {
+                merged.push_back(std::move(*left++));
+            }
+        }
+        for (; left != end(); ++left) {
+            merged.push_back(std::move(*left));
+        }
+        for (; right != other.end(); ++right) {
+            merged.push_back(std::move(*right));
+        }
+        other.clear();
+        clear();
+        for (T& value : merged) {
+            push_back(std::move(value));
+        }
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::splice(const_iterator pos, unrolled_list& other) {
+        if (this == &other || other.empty()) {
+            return;
+        }
+        Link *before = const_cast<Link*>(pos.link);
+        if (pos.index > 0) {
+            before = split(node(before), pos.index);
+        }
+        Link *first = other.sentinel.next, *last = other.sentinel.prev;
+        first->prev = before->prev;
+        before->prev->next = first;
+        last->next = before;
+        before->prev = last;
+        size_ += other.size_;
+        other.sentinel.next = other.sentinel.prev = &other.sentinel;
+        other.size_ = 0;
+    }
+
+    // Destroys everything from first to the end.
+    template <class T, class Alloc, size_t Capacity>
+    typename unrolled_list<T, Alloc, Capacity>::iterator unrolled_list<T, Alloc, Capacity>::truncate(iterator first) {
+        if (first == end()) {
+            return first;
+        }
+        Node *target = node(first.link);
+        for (size_t i = first.index; i < target->count; ++i) {
+            target->item(i).~T();
+            --size_;
+        }
+        target->count = first.index;
+        Link *link = target->next;
+        if (target->count == 0) {
+            destroy_node(target);
+        }
+        while (link != &sentinel) {
+            Node *doomed = node(link);
+            link = link->next;
+            for (size_t i = 0; i < doomed->count; ++i) {
+                doomed->item(i).~T();
+            }
+            size_ -= doomed->count;
+            destroy_node(doomed);
+        }
+        return end();
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::remove(const T& value) {
+        // value may be an element of this list, which gets overwritten.
+        const T copy = value;
+        iterator kept = begin();
+        for (iterator it = begin(); it != end(); ++it) {
+            if (!(*it == copy)) {
+                if (kept != it) {
+                    *kept = std::move(*it);
+                }
+                ++kept;
+            }
+        }
+        truncate(kept);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::reverse() {
+        Link *link = &sentinel;
+        do {
+            std::swap(link->next, link->prev);
+            link = link->prev;
+            if (link != &sentinel) {
+                std::reverse(node(link)->slot(0), node(link)->slot(node(link)->count));
+            }
+        } while (link != &sentinel);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::unique() {
+        if (size_ < 2) {
+            return;
+        }
+        iterator last = begin();
+        iterator it = last;
+        for (++it; it != end(); ++it) {
+            if (!(*it == *last)) {
+                ++last;
+                if (last != it) {
+                    *last = std::move(*it);
+                }
+            }
+        }
+        truncate(++last);
+    }
+
+    template <class T, class Alloc, size_t Capacity>
+    void unrolled_list<T, Alloc, Capacity>::sort() {
+        std::vector<T> values;
+        values.reserve(size_);
+        for (iterator it = begin(); it != end(); ++it) {
+            values.push_back(std::move(*it));
+        }
+        std::stable_sort(values.begin(), values.end());
+        iterator it = begin();
+        for (T& value : values) {
+            *it++ = std::move(value);
+        }
+    }
+
+}  // namespace task
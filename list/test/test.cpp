@@ -4,7 +4,12 @@
 #include <algorithm>
 #include <vector>
 #include <list>
+#include <functional>
+#include <numeric>
+#include <thread>
+#include <type_traits>
 #include "src/list.h"
+#include "src/unrolled_list.h"
 
 
 size_t RandomUInt(size_t max = -1) {
@@ -53,6 +58,11 @@ struct MoveTester {
     MoveTester& operator=(MoveTester&&) noexcept { action = "MA"; return *this; }
 };
 
+struct NoDefault {
+    explicit NoDefault(size_t v) : value(v) {}
+    size_t value;
+};
+
 struct ArgForwardTester {
     std::string actions;
 
@@ -62,6 +72,27 @@ struct ArgForwardTester {
 };
 
 
+// std::allocator that counts allocations made through any of its copies.
+template <class T>
+struct CountingAllocator : std::allocator<T> {
+    static inline size_t allocations = 0;
+
+    template <class U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    CountingAllocator() = default;
+    template <class U>
+    CountingAllocator(const CountingAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        ++allocations;
+        return std::allocator<T>::allocate(count);
+    }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -209,6 +240,12 @@ int main() {
 
         ASSERT_EQUAL_MSG(list_task, list_std, "list::sort")
 
+        list_task.sort(std::greater<size_t>());
+        list_std.sort(std::greater<size_t>());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort with a comparator")
+        list_task.sort();
+        list_std.sort();
+
         list_task.unique();
         list_std.unique();
 
@@ -272,6 +309,323 @@ int main() {
         }
     }
 
+    {
+        using counted_list = task::list<size_t, CountingAllocator<size_t>>;
+        counted_list list_task, list_task2;
+        std::list<size_t> list_std, list_std2;
+        RandomFill(list_std, RandomUInt(100, 1000), 100);
+        RandomFill(list_std2, RandomUInt(100, 1000), 100);
+        for (size_t value : list_std) {
+            list_task.push_back(value);
+        }
+        for (size_t value : list_std2) {
+            list_task2.push_back(value);
+        }
+        const size_t allocations = CountingAllocator<size_t>::allocations;
+
+        auto descending = std::greater<size_t>();
+        list_task.sort(descending);
+        list_std.sort(descending);
+        list_task2.sort(descending);
+        list_std2.sort(descending);
+        auto element = list_task2.begin();
+        const size_t element_value = *element;
+        list_task.merge(list_task2, descending);
+        list_std.merge(list_std2, descending);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::merge with a comparator")
+        ASSERT_TRUE_MSG(list_task2.empty() && list_task.size() == list_std.size(), "list::merge sizes")
+        bool element_found = false;
+        for (auto it = list_task.begin(); it != list_task.end(); ++it) {
+            element_found = element_found || it == element;
+        }
+        ASSERT_TRUE_MSG(*element == element_value && element_found, "list::merge keeps iterators")
+
+        auto odd = [](size_t value) { return value % 2 == 1; };
+        list_task.remove_if(odd);
+        list_std.remove_if(odd);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::remove_if")
+
+        auto same_tens = [](size_t lhs, size_t rhs) { return lhs / 10 == rhs / 10; };
+        list_task.unique(same_tens);
+        list_std.unique(same_tens);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::unique with a predicate")
+
+        // Single elements and ranges, from another list and from this one.
+        list_task.splice(list_task.begin(), list_task, std::prev(list_task.end()));
+        list_std.splice(list_std.begin(), list_std, std::prev(list_std.end()));
+        list_task.splice(list_task.end(), list_task, list_task.begin());
+        list_std.splice(list_std.end(), list_std, list_std.begin());
+        list_task.splice(list_task.end(), list_task, list_task.begin(), std::next(list_task.begin(), 3));
+        list_std.splice(list_std.end(), list_std, list_std.begin(), std::next(list_std.begin(), 3));
+        list_task.splice(list_task.begin(), list_task, list_task.begin());
+        list_std.splice(list_std.begin(), list_std, list_std.begin());
+        list_task.splice(std::next(list_task.begin(), 2), list_task, std::next(list_task.begin()));
+        list_std.splice(std::next(list_std.begin(), 2), list_std, std::next(list_std.begin()));
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice within a list")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "list::splice within a list keeps size")
+
+        list_task2.splice(list_task2.end(), list_task, std::next(list_task.begin()));
+        list_std2.splice(list_std2.end(), list_std, std::next(list_std.begin()));
+        list_task2.splice(list_task2.begin(), list_task, std::next(list_task.begin(), 2), std::prev(list_task.end(), 2));
+        list_std2.splice(list_std2.begin(), list_std, std::next(list_std.begin(), 2), std::prev(list_std.end(), 2));
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice of a range")
+        ASSERT_EQUAL_MSG(list_task2, list_std2, "list::splice of a range")
+        ASSERT_TRUE_MSG(list_task.size() == list_std.size() && list_task2.size() == list_std2.size(),
+                        "list::splice of a range sizes")
+
+        list_task.remove(list_task.back());
+        list_std.remove(list_std.back());
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::remove of an element of the list")
+        ASSERT_TRUE_MSG(CountingAllocator<size_t>::allocations == allocations,
+                        "merge, remove, unique and splice do not allocate")
+
+        list_task.splice(list_task.begin(), counted_list(list_task2));
+        list_std.splice(list_std.begin(), std::list<size_t>(list_std2));
+        list_task.sort();
+        list_std.sort();
+        list_task2.sort();
+        list_std2.sort();
+        list_task.merge(counted_list(list_task2));
+        list_std.merge(std::list<size_t>(list_std2));
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::splice and list::merge of temporaries")
+    }
+
+    {
+        using counted_list = task::list<size_t, CountingAllocator<size_t>>;
+        static_assert(std::is_nothrow_default_constructible_v<counted_list>);
+        static_assert(std::is_nothrow_move_constructible_v<counted_list>);
+        static_assert(std::is_nothrow_move_assignable_v<counted_list>);
+
+        const size_t allocations = CountingAllocator<size_t>::allocations;
+        std::vector<counted_list> lists(1000);
+        counted_list moved(std::move(lists.front()));
+        lists.back() = std::move(moved);
+        ASSERT_TRUE_MSG(CountingAllocator<size_t>::allocations == allocations,
+                        "empty lists do not allocate")
+
+        // Moving, swapping and reversing leave end() and the links consistent.
+        counted_list list_task;
+        std::list<size_t> list_std;
+        RandomFill(list_std, 100);
+        for (size_t value : list_std) {
+            list_task.push_back(value);
+        }
+        counted_list other(std::move(list_task));
+        ASSERT_TRUE_MSG(list_task.empty() && list_task.begin() == list_task.end(), "list move leaves it empty")
+        list_task.swap(other);
+        ASSERT_TRUE_MSG(other.empty(), "list::swap with an empty list")
+        list_task.reverse();
+        list_std.reverse();
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::reverse")
+        ASSERT_TRUE_MSG(std::equal(list_task.rbegin(), list_task.rend(), list_std.rbegin(), list_std.rend()),
+                        "list reverse iterators")
+        other.push_back(1);
+        list_task.swap(other);
+        ASSERT_TRUE_MSG(list_task.size() == 1 && list_task.front() == 1 && std::prev(list_task.end()) == list_task.begin(),
+                        "list::swap")
+        ASSERT_EQUAL_MSG(other, list_std, "list::swap")
+
+        // No T in the sentinel, so T needs no default constructor.
+        task::list<NoDefault> no_default;
+        no_default.emplace_back(1);
+        no_default.push_front(NoDefault(0));
+        no_default.insert(no_default.end(), 2, NoDefault(2));
+        ASSERT_TRUE_MSG(no_default.size() == 4 && no_default.front().value == 0 && no_default.back().value == 2,
+                        "list of a type without a default constructor")
+    }
+
+    {
+        // Sorting is stable and keeps nodes: iterators follow their elements.
+        task::list<std::pair<size_t, size_t>> list_task;
+        std::list<std::pair<size_t, size_t>> list_std;
+        for (size_t i = 0; i < 3000; ++i) {
+            list_task.emplace_back(RandomUInt(50), i);
+            list_std.emplace_back(list_task.back());
+        }
+        auto by_key = [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; };
+        auto first = list_task.begin();
+        const auto first_value = *first;
+        list_task.sort(by_key);
+        list_std.sort(by_key);
+        ASSERT_EQUAL_MSG(list_task, list_std, "list::sort is stable")
+        ASSERT_TRUE_MSG(*first == first_value, "list::sort keeps iterators")
+        ASSERT_TRUE_MSG(std::equal(list_task.crbegin(), list_task.crend(), list_std.crbegin(), list_std.crend()),
+                        "list::sort relinks prev")
+    }
+
+
+    {
+        task::pooled_list<size_t> list_task;
+        std::list<size_t> list_std;
+        for (size_t iter = 0; iter < 100; ++iter) {
+            size_t count = RandomUInt(0, 200);
+            for (; count; --count) {
+                auto val = RandomUInt(100);
+                list_task.push_back(val);
+                list_std.push_back(val);
+            }
+            count = RandomUInt(0, list_std.size());
+            for (; count; --count) {
+                list_task.pop_front();
+                list_std.pop_front();
+            }
+            if (!list_std.empty()) {
+                size_t offset = RandomUInt(0, list_std.size() - 1);
+                list_task.erase(std::next(list_task.begin(), offset));
+                list_std.erase(std::next(list_std.begin(), offset));
+            }
+            list_task.insert(list_task.begin(), RandomUInt(0, 10), 7);
+            list_std.insert(list_std.begin(), list_task.size() - list_std.size(), 7);
+            ASSERT_EQUAL_MSG(list_task, list_std, "pooled_list churn")
+        }
+
+        task::pooled_list<size_t> other(list_task);
+        list_task.splice(list_task.begin(), other);
+        list_std.splice(list_std.begin(), std::list<size_t>(list_std));
+        list_task.sort();
+        list_std.sort();
+        ASSERT_EQUAL_MSG(list_task, list_std, "pooled_list splice and sort")
+
+        // Nodes outlive the thread whose pool they came from.
+        task::pooled_list<std::string> strings;
+        std::thread([&strings] {
+            task::pooled_list<std::string> local(100, "pooled");
+            strings.splice(strings.begin(), local);
+        }).join();
+        strings.resize(50);
+        strings.push_back("back");
+        ASSERT_TRUE_MSG(strings.size() == 51 && strings.front() == "pooled" && strings.back() == "back",
+                        "pooled_list across threads")
+    }
+
+
+    {
+        // A small capacity so nodes split and merge all the time.
+        task::unrolled_list<size_t, std::allocator<size_t>, 4> list_task;
+        std::list<size_t> list_std;
+        for (size_t iter = 0; iter < 2000; ++iter) {
+            size_t offset = RandomUInt(0, list_std.size());
+            switch (RandomUInt(6)) {
+                case 0:
+                case 1: {
+                    auto val = RandomUInt(20);
+                    auto it = list_task.insert(std::next(list_task.begin(), offset), val);
+                    list_std.insert(std::next(list_std.begin(), offset), val);
+                    ASSERT_TRUE_MSG(*it == val, "unrolled_list::insert result")
+                    break;
+                }
+                case 2: {
+                    size_t count = RandomUInt(0, 10);
+                    list_task.insert(std::next(list_task.begin(), offset), count, 7);
+                    list_std.insert(std::next(list_std.begin(), offset), count, 7);
+                    break;
+                }
+                case 3:
+                    if (offset < list_std.size()) {
+                        auto it = list_task.erase(std::next(list_task.begin(), offset));
+                        auto it_std = list_std.erase(std::next(list_std.begin(), offset));
+                        ASSERT_TRUE_MSG(std::distance(list_task.begin(), it) == std::distance(list_std.begin(), it_std),
+                                        "unrolled_list::erase result")
+                    }
+                    break;
+                case 4: {
+                    size_t last = RandomUInt(offset, list_std.size());
+                    list_task.erase(std::next(list_task.begin(), offset), std::next(list_task.begin(), last));
+                    list_std.erase(std::next(list_std.begin(), offset), std::next(list_std.begin(), last));
+                    break;
+                }
+                case 5:
+                    if (TossCoin()) {
+                        list_task.push_front(iter);
+                        list_std.push_front(iter);
+                    } else {
+                        list_task.pop_back();
+                        if (!list_std.empty()) {
+                            list_std.pop_back();
+                        }
+                    }
+                    break;
+                case 6:
+                    switch (RandomUInt(3)) {
+                        case 0:
+                            if (!list_std.empty()) {
+                                list_task.remove(list_task.front());
+                                list_std.remove(list_std.front());
+                            }
+                            break;
+                        case 1:
+                            list_task.unique();
+                            list_std.unique();
+                            break;
+                        case 2:
+                            list_task.reverse();
+                            list_std.reverse();
+                            break;
+                        case 3:
+                            list_task.sort();
+                            list_std.sort();
+                            break;
+                    }
+                    break;
+            }
+            ASSERT_TRUE_MSG(list_task.size() == list_std.size(), "unrolled_list::size")
+            ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list against std::list")
+            ASSERT_TRUE_MSG(std::equal(list_task.rbegin(), list_task.rend(), list_std.rbegin(), list_std.rend()),
+                            "unrolled_list reverse iteration")
+        }
+
+        // Elements in other nodes do not move on insert and erase.
+        task::unrolled_list<size_t, std::allocator<size_t>, 4> stable(12, 0);
+        std::iota(stable.begin(), stable.end(), 0);
+        auto first = stable.begin();
+        auto last = std::prev(stable.end());
+        stable.insert(std::next(stable.begin(), 6), 100);
+        stable.erase(std::next(stable.begin(), 5));
+        ASSERT_TRUE_MSG(*first == 0 && *last == 11, "unrolled_list iterator stability")
+
+        task::unrolled_list<size_t, std::allocator<size_t>, 4> other, sorted;
+        RandomFill(other, 30, 50);
+        RandomFill(sorted, 20, 50);
+        std::list<size_t> other_std(other.begin(), other.end()), sorted_std(sorted.begin(), sorted.end());
+        other.sort();
+        sorted.sort();
+        other_std.sort();
+        sorted_std.sort();
+        sorted.merge(other);
+        sorted_std.merge(other_std);
+        ASSERT_TRUE_MSG(other.empty(), "unrolled_list::merge empties its argument")
+        ASSERT_EQUAL_MSG(sorted, sorted_std, "unrolled_list::merge")
+
+        auto pos = std::next(list_task.begin(), list_task.size() / 2);
+        auto pos_std = std::next(list_std.begin(), list_std.size() / 2);
+        auto spliced = sorted.begin();
+        const size_t spliced_value = *spliced;
+        list_task.splice(pos, sorted);
+        list_std.splice(pos_std, sorted_std);
+        ASSERT_TRUE_MSG(sorted.empty() && *spliced == spliced_value, "unrolled_list::splice keeps iterators")
+        ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list::splice")
+
+        task::unrolled_list<size_t, std::allocator<size_t>, 4> moved(std::move(list_task));
+        list_task.swap(moved);
+        moved = list_task;
+        list_task.resize(3);
+        list_std.resize(3);
+        ASSERT_EQUAL_MSG(list_task, list_std, "unrolled_list::resize")
+        ASSERT_TRUE_MSG(moved.size() >= list_task.size(), "unrolled_list copy")
+
+        task::unrolled_list<MoveTester> movers;
+        movers.emplace_back();
+        movers.push_front(MoveTester());
+        ASSERT_TRUE_MSG(movers.size() == 2 && movers.front().action == "MC" && movers.back().action == "MC",
+                        "unrolled_list moves elements into place")
+
+        task::unrolled_list<std::string> strings(100, "unrolled");
+        strings.erase(std::next(strings.begin()), std::prev(strings.end()));
+        ASSERT_TRUE_MSG(strings.size() == 2 && strings.front() == "unrolled" && strings.back() == "unrolled",
+                        "unrolled_list of strings")
+    }
+
+
     {
         const size_t LIST_COUNT = 5;
         const size_t ITER_COUNT = 4000;
@@ -0,0 +1,12 @@
+#!/bin/bash
+
+set -e
+
+SOURCES="src/matrix.cpp src/gemm.cpp src/lu.cpp src/cholesky.cpp src/qr.cpp src/conjugate_gradient.cpp src/thread_pool.cpp src/sparse.cpp src/binary_io.cpp src/text_io.cpp src/batch.cpp src/profile.cpp src/pool.cpp"
+BENCH=${1:-gemm}
+shift || true
+
+g++ -std=c++17 -pthread -O2 $CXXFLAGS -I./ bench/${BENCH}_bench.cpp $SOURCES -o ${BENCH}_bench
+./${BENCH}_bench "$@"
+
+rm ${BENCH}_bench
@@ -0,0 +1,82 @@
+#include <cstdio>
+#include <string>
+#include "bench/bench.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+
+
+// Per-element cost of each accessor in one build: the checked get(),
+// operator[] and operator(), unchecked(), and a raw pointer walk as the
+// floor. There is no checked/unchecked build mode to compare; the gap
+// between the checked rows and unchecked() is what a loop saves by
+// checking its ranges once and switching accessor.
+// Usage: accessor_bench [n]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 512;
+
+    Matrix matrix(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i][j] = bench::RandomDouble();
+        }
+    }
+    const double elements = static_cast<double>(n) * n;
+
+    const double get = bench::SecondsPerRun([&] {
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += matrix.get(i, j);
+            }
+        }
+        bench::DoNotOptimize(sum);
+    });
+    const double brackets = bench::SecondsPerRun([&] {
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += matrix[i][j];
+            }
+        }
+        bench::DoNotOptimize(sum);
+    });
+    const double call = bench::SecondsPerRun([&] {
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += matrix(i, j);
+            }
+        }
+        bench::DoNotOptimize(sum);
+    });
+    const double unchecked = bench::SecondsPerRun([&] {
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                sum += matrix.unchecked(i, j);
+            }
+        }
+        bench::DoNotOptimize(sum);
+    });
+    const double raw = bench::SecondsPerRun([&] {
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            const double* row = matrix.data() + i * matrix.getStride();
+            for (size_t j = 0; j < n; ++j) {
+                sum += row[j];
+            }
+        }
+        bench::DoNotOptimize(sum);
+    });
+
+    std::printf("%zu x %zu\n", n, n);
+    std::printf("%12s %12s\n", "", "ns/element");
+    std::printf("%12s %12.3f\n", "get()", get / elements * 1e9);
+    std::printf("%12s %12.3f\n", "operator[]", brackets / elements * 1e9);
+    std::printf("%12s %12.3f\n", "operator()", call / elements * 1e9);
+    std::printf("%12s %12.3f\n", "unchecked()", unchecked / elements * 1e9);
+    std::printf("%12s %12.3f\n", "pointer", raw / elements * 1e9);
+    return 0;
+}
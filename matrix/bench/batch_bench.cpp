@@ -0,0 +1,119 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench/bench.h"
+#include "src/batch.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+using task::MatrixBatch;
+using task::StaticMatrixD;
+
+
+// Matrices per second for N x N products, determinants, inverses and
+// transposes: a Matrix per item, a StaticMatrix per item, and MatrixBatch.
+template <size_t N>
+void Run(size_t count) {
+    MatrixBatch batch_a(count, N, N), batch_b(count, N, N);
+    std::vector<StaticMatrixD<N, N>> static_a(count), static_b(count), static_c(count);
+    std::vector<double> static_det(count);
+    std::vector<Matrix> dynamic_a, dynamic_b;
+    for (size_t n = 0; n < count; ++n) {
+        for (size_t i = 0; i < N; ++i) {
+            for (size_t j = 0; j < N; ++j) {
+                static_a[n](i, j) = batch_a(n, i, j) = bench::RandomDouble();
+                static_b[n](i, j) = batch_b(n, i, j) = bench::RandomDouble();
+            }
+        }
+        dynamic_a.push_back(static_a[n].toMatrix());
+        dynamic_b.push_back(static_b[n].toMatrix());
+    }
+
+    const double dynamic[] = {
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                Matrix c = dynamic_a[n] * dynamic_b[n];
+                bench::DoNotOptimize(c);
+            }
+        }),
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                bench::DoNotOptimize(dynamic_a[n].det());
+            }
+        }),
+        0.,
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                Matrix c = dynamic_a[n].transposed();
+                bench::DoNotOptimize(c);
+            }
+        }),
+    };
+    const double fixed[] = {
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                static_c[n] = static_a[n] * static_b[n];
+            }
+            bench::DoNotOptimize(static_c);
+        }),
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                static_det[n] = static_a[n].det();
+            }
+            bench::DoNotOptimize(static_det);
+        }),
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                static_c[n] = static_a[n].inverse();
+            }
+            bench::DoNotOptimize(static_c);
+        }),
+        bench::SecondsPerRun([&] {
+            for (size_t n = 0; n < count; ++n) {
+                static_c[n] = static_a[n].transposed();
+            }
+            bench::DoNotOptimize(static_c);
+        }),
+    };
+    MatrixBatch batch_c(0, 0, 0);
+    std::vector<double> batch_det;
+    const double batched[] = {
+        bench::SecondsPerRun([&] {
+            batch_a.multiply(batch_b, batch_c);
+            bench::DoNotOptimize(batch_c);
+        }),
+        bench::SecondsPerRun([&] {
+            batch_a.det(batch_det);
+            bench::DoNotOptimize(batch_det);
+        }),
+        bench::SecondsPerRun([&] {
+            batch_a.inverse(batch_c);
+            bench::DoNotOptimize(batch_c);
+        }),
+        bench::SecondsPerRun([&] {
+            batch_a.transposed(batch_c);
+            bench::DoNotOptimize(batch_c);
+        }),
+    };
+
+    const char* names[] = {"multiply", "det", "inverse", "transpose"};
+    for (size_t k = 0; k < 4; ++k) {
+        std::printf("%zux%zu %10s %14.3e %14.3e %14.3e\n", N, N, names[k],
+                    dynamic[k] > 0. ? count / dynamic[k] : 0., count / fixed[k],
+                    count / batched[k]);
+    }
+}
+
+
+// Usage: batch_bench [count]
+int main(int argc, char** argv) {
+    const size_t count = argc > 1 ? std::stoul(argv[1]) : 1 << 18;
+
+    std::printf("%zu matrices, matrices/s (Matrix has no inverse())\n", count);
+    std::printf("%14s %14s %14s %14s\n", "", "Matrix", "StaticMatrix", "MatrixBatch");
+    Run<2>(count);
+    Run<3>(count);
+    Run<4>(count);
+    return 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <random>
+
+
+namespace bench {
+
+// Keeps the optimizer from discarding a computed value.
+template <class T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Timing {
+    // Average wall time of one run.
+    double seconds;
+    size_t runs;
+};
+
+// Runs `body` repeatedly for at least `min_seconds` (and at least once).
+template <class Body>
+Timing Time(Body&& body, double min_seconds = 0.2) {
+    using Clock = std::chrono::steady_clock;
+    size_t runs = 0;
+    const auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do {
+        body();
+        ++runs;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < min_seconds);
+    return {elapsed.count() / runs, runs};
+}
+
+// The average wall time of one run of `body` in seconds, see Time().
+template <class Body>
+double SecondsPerRun(Body&& body, double min_seconds = 0.2) {
+    return Time(body, min_seconds).seconds;
+}
+
+inline double RandomDouble() {
+    static std::mt19937 rand(42);
+
+    std::uniform_real_distribution<double> dist{-10., 10.};
+    return dist(rand);
+}
+
+}  // namespace bench
@@ -0,0 +1,59 @@
+import argparse
+import json
+import sys
+
+
+# Compares two benchmark JSON files (matrix_bench --benchmark_out, or Google
+# Benchmark output) by real_time per benchmark name. Exits with status 1 if
+# any benchmark got slower than the baseline by more than the threshold.
+#
+#   python3 bench/compare.py baseline.json current.json [--threshold 10]
+
+UNITS = {'ns': 1., 'us': 1e3, 'ms': 1e6, 's': 1e9}
+
+
+def load(path):
+    with open(path) as file:
+        data = json.load(file)
+    times = {}
+    for entry in data['benchmarks']:
+        if entry.get('run_type', 'iteration') != 'iteration':
+            continue
+        times[entry['name']] = entry['real_time'] * UNITS[entry.get('time_unit', 'ns')]
+    return times
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Flag benchmark regressions against a baseline.')
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    parser.add_argument('--threshold', type=float, default=10.,
+                        help='slowdown in percent that counts as a regression (default 10)')
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print('%-24s %14s %14s %9s' % ('Benchmark', 'Baseline (ns)', 'Current (ns)', 'Change'))
+    for name, time in current.items():
+        if name not in baseline:
+            print('%-24s %14s %14.0f %9s' % (name, '-', time, 'new'))
+            continue
+        change = (time / baseline[name] - 1.) * 100.
+        flag = ''
+        if change > args.threshold:
+            flag = '  REGRESSION'
+            regressions += 1
+        print('%-24s %14.0f %14.0f %+8.1f%%%s' % (name, baseline[name], time, change, flag))
+    for name in baseline:
+        if name not in current:
+            print('%-24s %14.0f %14s %9s' % (name, baseline[name], '-', 'missing'))
+
+    if regressions:
+        print('%d benchmark(s) slower by more than %g%%' % (regressions, args.threshold))
+        sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,68 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include "bench/bench.h"
+#include "src/gemm.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+using task::MatrixF;
+
+
+template <class M = Matrix>
+M RandomMatrix(size_t rows, size_t cols) {
+    M temp(rows, cols);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+
+// Compares the kernel behind Matrix::operator* against the textbook i-j-k
+// loop it replaced, plus the same kernel on single precision.
+// Usage: gemm_bench [max_size]
+int main(int argc, char** argv) {
+    const size_t max_size = argc > 1 ? std::stoul(argv[1]) : 2048;
+
+    std::printf("kernel: %s\n", task::gemm::kernelName());
+    std::printf("%6s %14s %14s %9s %14s\n", "n", "ijk GFLOP/s", "gemm GFLOP/s", "speedup",
+                "float GFLOP/s");
+
+    for (size_t n = 8; n <= max_size; n *= 2) {
+        const Matrix a = RandomMatrix(n, n);
+        const Matrix b = RandomMatrix(n, n);
+        Matrix c(n, n);
+        const MatrixF fa = RandomMatrix<MatrixF>(n, n);
+        const MatrixF fb = RandomMatrix<MatrixF>(n, n);
+        MatrixF fc(n, n);
+        const double flops = 2.0 * n * n * n;
+
+        const double reference = bench::SecondsPerRun([&] {
+            task::gemm::reference(n, n, n, a.data(), a.getStride(),
+                                  b.data(), b.getStride(), c.data(), c.getStride());
+            bench::DoNotOptimize(c);
+        });
+        const double product = bench::SecondsPerRun([&] {
+            std::memset(c.data(), 0, n * c.getStride() * sizeof(double));
+            task::gemm::multiply(n, n, n, a.data(), a.getStride(),
+                                 b.data(), b.getStride(), c.data(), c.getStride());
+            bench::DoNotOptimize(c);
+        });
+        const double single = bench::SecondsPerRun([&] {
+            std::memset(fc.data(), 0, n * fc.getStride() * sizeof(float));
+            task::gemm::multiply(n, n, n, fa.data(), fa.getStride(),
+                                 fb.data(), fb.getStride(), fc.data(), fc.getStride());
+            bench::DoNotOptimize(fc);
+        });
+
+        std::printf("%6zu %14.2f %14.2f %8.1fx %14.2f\n", n,
+                    flops / reference * 1e-9, flops / product * 1e-9,
+                    reference / product, flops / single * 1e-9);
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include "bench/bench.h"
+#include "src/binary_io.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+
+
+// Load throughput of the text operator>> against the binary format, read
+// with Matrix::load() and mapped with Matrix::mmap() (then touched once).
+// Usage: io_bench [n] [path]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 2048;
+    const std::string path = argc > 2 ? argv[2] : "io_bench.tmp";
+
+    Matrix matrix(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i][j] = bench::RandomDouble();
+        }
+    }
+    const double megabytes = n * n * sizeof(double) / 1e6;
+
+    {
+        std::ofstream output(path);
+        output.precision(17);
+        output << n << ' ' << n << '\n' << matrix;
+    }
+    const double text = bench::SecondsPerRun([&] {
+        std::ifstream input(path);
+        Matrix result;
+        input >> result;
+        bench::DoNotOptimize(result);
+    });
+
+    const double save = bench::SecondsPerRun([&] { matrix.save(path); });
+    const double load = bench::SecondsPerRun([&] {
+        Matrix result = Matrix::load(path);
+        bench::DoNotOptimize(result);
+    });
+    const double mapped = bench::SecondsPerRun([&] {
+        Matrix result = Matrix::mmap(path);
+        double sum = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            sum += result[i][0] + result[i][n - 1];
+        }
+        bench::DoNotOptimize(sum);
+    });
+    std::remove(path.c_str());
+
+    std::printf("%zu x %zu doubles, %.1f MB\n", n, n, megabytes);
+    std::printf("%16s %10s %10s\n", "", "seconds", "MB/s");
+    std::printf("%16s %10.4f %10.1f\n", "text operator>>", text, megabytes / text);
+    std::printf("%16s %10.4f %10.1f\n", "binary save", save, megabytes / save);
+    std::printf("%16s %10.4f %10.1f\n", "binary load", load, megabytes / load);
+    std::printf("%16s %10.4f %10.1f\n", "mmap", mapped, megabytes / mapped);
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bench/bench.h"
+#include "src/gemm.h"
+#include "src/matrix.h"
+#include "src/text_io.h"
+#include "src/thread_pool.h"
+
+
+using task::Matrix;
+
+
+namespace {
+
+Matrix RandomMatrix(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+std::string Text(const Matrix& matrix) {
+    std::ostringstream output;
+    output.precision(17);
+    output << matrix.getRows() << ' ' << matrix.getCols() << '\n' << matrix;
+    return output.str();
+}
+
+const char* const kBinaryPath = "matrix_bench.bin";
+
+// One parameterized benchmark: `run(n, min_seconds)` times the operation on
+// n x n operands built outside the timed loop; `flops(n)` is the
+// arithmetic it does per run, 0 where that means nothing.
+struct Benchmark {
+    const char* name;
+    std::function<bench::Timing(size_t, double)> run;
+    std::function<double(size_t)> flops;
+};
+
+std::function<double(size_t)> NoFlops() {
+    return [](size_t) { return 0.; };
+}
+
+std::vector<Benchmark> Benchmarks() {
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back({"Construct", [](size_t n, double min_seconds) {
+        return bench::Time([&] {
+            Matrix matrix(n, n);
+            bench::DoNotOptimize(matrix);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"Copy", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        return bench::Time([&] {
+            Matrix copy(a);
+            bench::DoNotOptimize(copy);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"Add", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n), b = RandomMatrix(n);
+        Matrix c(n, n);
+        return bench::Time([&] {
+            c = a + b;
+            bench::DoNotOptimize(c);
+        }, min_seconds);
+    }, [](size_t n) { return 1. * n * n; }});
+    benchmarks.push_back({"Multiply", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n), b = RandomMatrix(n);
+        return bench::Time([&] {
+            Matrix c = a * b;
+            bench::DoNotOptimize(c);
+        }, min_seconds);
+    }, [](size_t n) { return 2. * n * n * n; }});
+    benchmarks.push_back({"Transpose", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        return bench::Time([&] {
+            Matrix t = a.transposed();
+            bench::DoNotOptimize(t);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"Det", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        return bench::Time([&] {
+            bench::DoNotOptimize(a.det());
+        }, min_seconds);
+    }, [](size_t n) { return 2. / 3. * n * n * n; }});
+    benchmarks.push_back({"Trace", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        return bench::Time([&] {
+            bench::DoNotOptimize(a.trace());
+        }, min_seconds);
+    }, [](size_t n) { return 1. * n; }});
+    benchmarks.push_back({"WriteText", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        return bench::Time([&] {
+            const std::string text = Text(a);
+            bench::DoNotOptimize(text);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"ReadText", [](size_t n, double min_seconds) {
+        const std::string text = Text(RandomMatrix(n));
+        Matrix result;
+        return bench::Time([&] {
+            std::istringstream input(text);
+            input >> result;
+            bench::DoNotOptimize(result);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"ReadTextBulk", [](size_t n, double min_seconds) {
+        const std::string text = Text(RandomMatrix(n));
+        Matrix result;
+        return bench::Time([&] {
+            std::istringstream input(text);
+            task::TextReader(input).read(result);
+            bench::DoNotOptimize(result);
+        }, min_seconds);
+    }, NoFlops()});
+    benchmarks.push_back({"SaveBinary", [](size_t n, double min_seconds) {
+        const Matrix a = RandomMatrix(n);
+        const bench::Timing timing = bench::Time([&] {
+            a.save(kBinaryPath);
+        }, min_seconds);
+        std::remove(kBinaryPath);
+        return timing;
+    }, NoFlops()});
+    benchmarks.push_back({"LoadBinary", [](size_t n, double min_seconds) {
+        RandomMatrix(n).save(kBinaryPath);
+        const bench::Timing timing = bench::Time([&] {
+            Matrix loaded = Matrix::load(kBinaryPath);
+            bench::DoNotOptimize(loaded);
+        }, min_seconds);
+        std::remove(kBinaryPath);
+        return timing;
+    }, NoFlops()});
+    return benchmarks;
+}
+
+struct Result {
+    std::string name;
+    size_t runs;
+    double nanoseconds;
+    double flops_per_second;
+};
+
+std::vector<size_t> ParseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::istringstream input(list);
+    std::string item;
+    while (std::getline(input, item, ',')) {
+        sizes.push_back(std::stoul(item));
+    }
+    return sizes;
+}
+
+bool StartsWith(const char* argument, const char* prefix, std::string* value) {
+    const size_t length = std::strlen(prefix);
+    if (std::strncmp(argument, prefix, length) != 0) {
+        return false;
+    }
+    *value = argument + length;
+    return true;
+}
+
+// Same layout as Google Benchmark's JSON output, so compare.py reads both.
+void WriteJson(const std::string& path, const std::vector<Result>& results) {
+    std::ofstream output(path);
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    output << "{\n  \"context\": {\n"
+           << "    \"date\": \"" << date << "\",\n"
+           << "    \"executable\": \"matrix_bench\",\n"
+           << "    \"num_threads\": " << task::parallel::threadCount() << ",\n"
+           << "    \"gemm_kernel\": \"" << task::gemm::kernelName() << "\"\n"
+           << "  },\n  \"benchmarks\": [";
+    output.precision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        output << (i == 0 ? "\n" : ",\n")
+               << "    {\"name\": \"" << result.name << "\", \"run_type\": \"iteration\", "
+               << "\"iterations\": " << result.runs << ", "
+               << "\"real_time\": " << result.nanoseconds << ", \"time_unit\": \"ns\"";
+        if (result.flops_per_second > 0.) {
+            output << ", \"flops_per_second\": " << result.flops_per_second;
+        }
+        output << "}";
+    }
+    output << "\n  ]\n}\n";
+}
+
+}  // namespace
+
+
+// Benchmarks of the everyday Matrix operations across sizes, each named
+// Operation/n. Save a baseline and compare later runs against it:
+//   bash bench.sh matrix --benchmark_out=baseline.json
+//   bash bench.sh matrix --benchmark_out=current.json
+//   python3 bench/compare.py baseline.json current.json --threshold 10
+// Usage: matrix_bench [--benchmark_filter=substring] [--sizes=16,64,...]
+//                     [--benchmark_min_time=seconds] [--benchmark_out=file.json]
+int main(int argc, char** argv) {
+    std::string filter, out, value;
+    std::vector<size_t> sizes = {16, 64, 256, 1024};
+    double min_seconds = 0.2;
+    for (int i = 1; i < argc; ++i) {
+        if (StartsWith(argv[i], "--benchmark_filter=", &value)) {
+            filter = value;
+        } else if (StartsWith(argv[i], "--sizes=", &value)) {
+            sizes = ParseSizes(value);
+        } else if (StartsWith(argv[i], "--benchmark_min_time=", &value)) {
+            min_seconds = std::stod(value);
+        } else if (StartsWith(argv[i], "--benchmark_out=", &value)) {
+            out = value;
+        } else {
+            std::fprintf(stderr, "unknown argument: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::printf("%-24s %16s %12s %12s\n", "Benchmark", "Time (ns)", "Iterations", "GFLOP/s");
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : Benchmarks()) {
+        for (size_t n : sizes) {
+            const std::string name = std::string(benchmark.name) + "/" + std::to_string(n);
+            if (name.find(filter) == std::string::npos) {
+                continue;
+            }
+            const bench::Timing timing = benchmark.run(n, min_seconds);
+            const double flops = benchmark.flops(n);
+            results.push_back({name, timing.runs, timing.seconds * 1e9,
+                               flops / timing.seconds});
+            std::printf("%-24s %16.0f %12zu", name.c_str(), timing.seconds * 1e9, timing.runs);
+            if (flops > 0.) {
+                std::printf(" %12.2f", flops / timing.seconds * 1e-9);
+            }
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+    }
+    if (!out.empty()) {
+        WriteJson(out, results);
+    }
+    return 0;
+}
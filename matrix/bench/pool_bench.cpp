@@ -0,0 +1,56 @@
+#include <cstdio>
+#include <string>
+#include "bench/bench.h"
+#include "src/matrix.h"
+#include "src/pool.h"
+
+
+using task::Matrix;
+
+
+Matrix RandomMatrix(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+
+// Allocations made by `c = a * b + d` in a loop, where a * b is a
+// temporary: with the pool only the first iteration reaches operator new.
+// Build it both ways and compare.
+//   bash bench.sh pool
+//   CXXFLAGS=-DTASK_MATRIX_POOL=0 bash bench.sh pool
+// Usage: pool_bench [iterations]
+int main(int argc, char** argv) {
+    const size_t iterations = argc > 1 ? std::stoul(argv[1]) : 1000;
+
+    std::printf("buffer pool %s\n", task::pool::kEnabled ? "on" : "off");
+    std::printf("%6s %16s %16s %12s\n", "n", "first iteration", "allocs/iteration", "ns/iteration");
+    for (size_t n : {4, 16, 64, 256}) {
+        const Matrix a = RandomMatrix(n), b = RandomMatrix(n), d = RandomMatrix(n);
+        Matrix c(n, n);
+
+        task::pool::resetStats();
+        c = a * b + d;
+        const uint64_t first = task::pool::stats().misses;
+
+        task::pool::resetStats();
+        for (size_t i = 0; i < iterations; ++i) {
+            c = a * b + d;
+            bench::DoNotOptimize(c);
+        }
+        const double steady = static_cast<double>(task::pool::stats().misses) / iterations;
+
+        const double seconds = bench::SecondsPerRun([&] {
+            c = a * b + d;
+            bench::DoNotOptimize(c);
+        });
+        std::printf("%6zu %16llu %16.2f %12.0f\n", n, static_cast<unsigned long long>(first),
+                    steady, seconds * 1e9);
+    }
+    return 0;
+}
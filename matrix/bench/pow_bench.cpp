@@ -0,0 +1,74 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include "bench/bench.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+using task::MatrixMod;
+
+
+template <class M>
+M RandomMatrix(size_t n) {
+    M temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = typename M::value_type(static_cast<int64_t>(bench::RandomDouble() * 1e6));
+        }
+    }
+    return temp;
+}
+
+// Repeated squaring written against the plain operators, allocating a new
+// matrix for every product.
+template <class M>
+M SquaringPow(M base, uint64_t k) {
+    M result(base.getRows(), base.getCols());
+    for (; k > 0; k >>= 1) {
+        if (k & 1) {
+            result *= base;
+        }
+        base = base * base;
+    }
+    return result;
+}
+
+template <class M>
+void Run(const char* name, size_t n, uint64_t k, size_t steps) {
+    const M mat = RandomMatrix<M>(n);
+    const double loop = bench::SecondsPerRun([&] {
+        M result(n, n);
+        for (size_t i = 0; i < steps; ++i) {
+            result *= mat;
+        }
+        bench::DoNotOptimize(result);
+    });
+    const double squaring = bench::SecondsPerRun([&] {
+        M result = SquaringPow(mat, k);
+        bench::DoNotOptimize(result);
+    });
+    const double pow = bench::SecondsPerRun([&] {
+        M result = mat.pow(k);
+        bench::DoNotOptimize(result);
+    });
+    std::printf("%10s %6zu %14.3e %14.3e %14.3e\n", name, n, loop / steps, squaring, pow);
+}
+
+
+// Matrix powers the way a linear recurrence needs them: the cost of one
+// step of a `result *= mat` loop, and of A^k by repeated squaring through
+// the allocating operators and through pow().
+// Usage: pow_bench [k]
+int main(int argc, char** argv) {
+    const uint64_t k = argc > 1 ? std::stoull(argv[1]) : 1000000000000000000ull;
+    const size_t steps = 64;
+
+    std::printf("k = %llu, seconds\n", static_cast<unsigned long long>(k));
+    std::printf("%10s %6s %14s %14s %14s\n", "", "n", "one *= step", "squaring", "pow()");
+    for (size_t n : {8, 32, 128}) {
+        Run<Matrix>("Matrix", n, k, steps);
+        Run<MatrixMod>("MatrixMod", n, k, steps);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <string>
+#include "bench/bench.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+
+
+Matrix RandomMatrix(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+
+// Cost of the profiling hooks on operations small enough for them to show:
+// build it both ways and compare. The profiled build also prints its
+// report at exit.
+//   bash bench.sh profile
+//   CXXFLAGS=-DTASK_MATRIX_PROFILE=1 bash bench.sh profile
+// Usage: profile_bench [n]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 8;
+
+    const Matrix a = RandomMatrix(n);
+    const Matrix b = RandomMatrix(n);
+    Matrix c(n, n);
+    const double product = bench::SecondsPerRun([&] {
+        c = a * b;
+        bench::DoNotOptimize(c);
+    });
+    const double sum = bench::SecondsPerRun([&] {
+        c = a + b * 2.;
+        bench::DoNotOptimize(c);
+    });
+    const double det = bench::SecondsPerRun([&] {
+        bench::DoNotOptimize(a.det());
+    });
+
+    std::printf("%zu x %zu, profiling %s\n", n, n, task::profile::kEnabled ? "on" : "off");
+    std::printf("%12s %12s\n", "", "ns/call");
+    std::printf("%12s %12.1f\n", "a * b", product * 1e9);
+    std::printf("%12s %12.1f\n", "a + b * 2", sum * 1e9);
+    std::printf("%12s %12.1f\n", "det()", det * 1e9);
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include "bench/bench.h"
+#include "src/lu.h"
+#include "src/matrix.h"
+#include "src/thread_pool.h"
+
+
+using task::Matrix;
+
+
+Matrix RandomMatrix(size_t rows, size_t cols) {
+    Matrix temp(rows, cols);
+    for (size_t row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < cols; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+bool SameBits(const Matrix& a, const Matrix& b) {
+    return std::memcmp(a.data(), b.data(),
+                       a.getRows() * a.getStride() * sizeof(double)) == 0;
+}
+
+
+// Runs each parallel kernel with 1..max_threads threads, reports the speedup
+// over one thread and checks that the results are bit-for-bit identical.
+// Usage: scaling_bench [max_threads] [size]
+int main(int argc, char** argv) {
+    const size_t max_threads = argc > 1 ? std::stoul(argv[1])
+                                        : std::max(1u, std::thread::hardware_concurrency());
+    const size_t n = argc > 2 ? std::stoul(argv[2]) : 1024;
+
+    const Matrix a = RandomMatrix(n, n);
+    const Matrix b = RandomMatrix(n, n);
+    const Matrix product = a * b;
+    const Matrix transposed = a.transposed();
+
+    std::printf("n = %zu\n", n);
+    std::printf("%7s %10s %10s %10s %10s %10s %10s\n",
+                "threads", "gemm", "+=", "*= 2", "transpose", "lu", "identical");
+
+    double base[5] = {};
+    for (size_t threads = 1; threads <= max_threads; ++threads) {
+        task::parallel::setThreadCount(threads);
+        Matrix c(n, n);
+        double seconds[5];
+
+        seconds[0] = bench::SecondsPerRun([&] { c = a * b; });
+        const bool identical_product = SameBits(c, product);
+        seconds[1] = bench::SecondsPerRun([&] { c += b; });
+        seconds[2] = bench::SecondsPerRun([&] { c *= 2.; });
+        seconds[3] = bench::SecondsPerRun([&] {
+            c = a.transposed();
+            bench::DoNotOptimize(c);
+        });
+        const bool identical_transpose = SameBits(c, transposed);
+        seconds[4] = bench::SecondsPerRun([&] {
+            bench::DoNotOptimize(task::LU(a).det());
+        });
+
+        std::printf("%7zu", threads);
+        for (size_t i = 0; i < 5; ++i) {
+            if (threads == 1) {
+                base[i] = seconds[i];
+            }
+            std::printf(" %9.2fx", base[i] / seconds[i]);
+        }
+        std::printf(" %10s\n", identical_product && identical_transpose ? "yes" : "NO");
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench/bench.h"
+#include "src/cholesky.h"
+#include "src/conjugate_gradient.h"
+#include "src/lu.h"
+#include "src/matrix.h"
+#include "src/qr.h"
+#include "src/sparse.h"
+
+
+using task::Matrix;
+
+
+Matrix RandomMatrix(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+// Symmetric and strictly diagonally dominant with a positive diagonal,
+// hence positive definite; built in O(n^2).
+Matrix RandomSpd(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < row; ++col) {
+            temp[row][col] = temp[col][row] = bench::RandomDouble() / n;
+        }
+    }
+    for (size_t row = 0; row < n; ++row) {
+        double sum = 0.;
+        for (size_t col = 0; col < n; ++col) {
+            sum += std::fabs(temp[row][col]);
+        }
+        temp[row][row] = 1. + sum;
+    }
+    return temp;
+}
+
+// The 5-point Laplacian on a side x side grid: the classic sparse SPD
+// system, whose condition number grows like side^2.
+task::SparseMatrix Laplacian(size_t side) {
+    const size_t n = side * side;
+    task::CooMatrix coo(n, n);
+    coo.reserve(5 * n);
+    for (size_t i = 0; i < n; ++i) {
+        coo.add(i, i, 4.);
+        if (i % side != 0) {
+            coo.add(i, i - 1, -1.);
+            coo.add(i - 1, i, -1.);
+        }
+        if (i >= side) {
+            coo.add(i, i - side, -1.);
+            coo.add(i - side, i, -1.);
+        }
+    }
+    return task::SparseMatrix(coo);
+}
+
+std::vector<double> RandomVector(size_t n) {
+    std::vector<double> temp(n);
+    for (double& value : temp) {
+        value = bench::RandomDouble();
+    }
+    return temp;
+}
+
+
+// Factorize-and-solve time of each solver on n x n systems, one right-hand
+// side. Targets, for n >= 1000:
+//   Cholesky  at least 1.7x faster than LU on the same SPD matrix (half
+//             the flops, the same gemm update);
+//   QR        at most 2.5x slower than LU (twice the flops, blocked
+//             reflectors so the bulk is still gemm);
+//   CG dense  under a tenth of Cholesky on a well-conditioned system,
+//             since it needs a few dozen matrix-vector products;
+//   CG sparse O(non-zeros) per iteration on the Laplacian of a grid with
+//             about n cells, iterations growing like sqrt(n).
+// Usage: solver_bench [max n]
+int main(int argc, char** argv) {
+    const size_t max_n = argc > 1 ? std::stoul(argv[1]) : 5000;
+
+    std::printf("%6s %10s %10s %7s %10s %7s %10s %6s %10s %6s\n", "n", "LU s", "Chol s",
+                "vs LU", "QR s", "vs LU", "CG s", "iters", "CG sp s", "iters");
+    for (size_t n : {100, 300, 1000, 3000, 5000}) {
+        if (n > max_n) {
+            break;
+        }
+        const Matrix spd = RandomSpd(n);
+        const Matrix general = RandomMatrix(n);
+        const std::vector<double> b = RandomVector(n);
+
+        const double lu = bench::SecondsPerRun([&] {
+            auto x = task::LU(spd).solve(b);
+            bench::DoNotOptimize(x);
+        });
+        const double cholesky = bench::SecondsPerRun([&] {
+            auto x = task::Cholesky(spd).solve(b);
+            bench::DoNotOptimize(x);
+        });
+        const double qr = bench::SecondsPerRun([&] {
+            auto x = task::QR(general).solve(b);
+            bench::DoNotOptimize(x);
+        });
+
+        task::ConjugateGradientResult dense;
+        const double cg = bench::SecondsPerRun([&] {
+            dense = task::conjugateGradient(spd, b);
+            bench::DoNotOptimize(dense);
+        });
+
+        const size_t side = static_cast<size_t>(std::sqrt(static_cast<double>(n)));
+        const task::SparseMatrix laplacian = Laplacian(side);
+        const std::vector<double> rhs = RandomVector(side * side);
+        task::ConjugateGradientResult sparse;
+        const double cg_sparse = bench::SecondsPerRun([&] {
+            sparse = task::conjugateGradient(laplacian, rhs);
+            bench::DoNotOptimize(sparse);
+        });
+
+        std::printf("%6zu %10.4f %10.4f %6.2fx %10.4f %6.2fx %10.4f %6zu %10.5f %6zu\n", n, lu,
+                    cholesky, lu / cholesky, qr, qr / lu, cg, dense.iterations, cg_sparse,
+                    sparse.iterations);
+        std::fflush(stdout);
+    }
+    return 0;
+}
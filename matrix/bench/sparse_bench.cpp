@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench/bench.h"
+#include "src/matrix.h"
+#include "src/sparse.h"
+#include "src/thread_pool.h"
+
+
+using task::Matrix;
+using task::SparseMatrix;
+
+
+SparseMatrix RandomSparse(size_t n, double density) {
+    static std::mt19937 rand(42);
+    std::uniform_int_distribution<size_t> position{0, n - 1};
+
+    const size_t entries = static_cast<size_t>(density * n * n);
+    task::CooMatrix coo(n, n);
+    coo.reserve(entries);
+    for (size_t k = 0; k < entries; ++k) {
+        coo.add(position(rand), position(rand), bench::RandomDouble());
+    }
+    return SparseMatrix(coo);
+}
+
+
+// SpMV on an n x n matrix of the given densities against a dense
+// matrix-vector product with the same values.
+// Usage: sparse_bench [n] [threads]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 4096;
+    const size_t threads = argc > 2 ? std::stoul(argv[2])
+                                    : std::max(1u, std::thread::hardware_concurrency());
+    task::parallel::setThreadCount(threads);
+
+    std::vector<double> x(n);
+    for (double& value : x) {
+        value = bench::RandomDouble();
+    }
+
+    std::printf("n = %zu, threads = %zu\n", n, threads);
+    std::printf("%9s %10s %12s %12s %12s %9s\n", "density", "nnz", "sparse MB",
+                "spmv GFLOP/s", "dense GFLOP/s", "speedup");
+
+    for (double density : {0.001, 0.003, 0.01, 0.03, 0.1}) {
+        const SparseMatrix sparse = RandomSparse(n, density);
+        const Matrix dense = sparse.toDense();
+        const size_t nnz = sparse.nonZeros();
+        const double megabytes = (nnz * (sizeof(double) + sizeof(size_t)) +
+                                  (n + 1) * sizeof(size_t)) / 1e6;
+
+        const double spmv = bench::SecondsPerRun([&] {
+            auto y = sparse * x;
+            bench::DoNotOptimize(y);
+        });
+        const double gemv = bench::SecondsPerRun([&] {
+            std::vector<double> y(n);
+            for (size_t i = 0; i < n; ++i) {
+                const double* row = dense.data() + i * dense.getStride();
+                double sum = 0.;
+                for (size_t j = 0; j < n; ++j) {
+                    sum += row[j] * x[j];
+                }
+                y[i] = sum;
+            }
+            bench::DoNotOptimize(y);
+        });
+
+        std::printf("%8.1f%% %10zu %12.1f %12.2f %12.2f %8.1fx\n", density * 100, nnz,
+                    megabytes, 2.0 * nnz / spmv * 1e-9, 2.0 * n * n / gemv * 1e-9,
+                    gemv / spmv);
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench/bench.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+using task::StaticMatrixD;
+
+const size_t kCount = 1024;
+
+
+// Throughput of 3x3 products through the dynamic Matrix and StaticMatrix.
+// Usage: static_bench
+int main() {
+    std::vector<Matrix> dynamic_a, dynamic_b;
+    std::vector<StaticMatrixD<3, 3>> static_a, static_b;
+    for (size_t n = 0; n < kCount; ++n) {
+        Matrix a(3, 3), b(3, 3);
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                a[i][j] = bench::RandomDouble();
+                b[i][j] = bench::RandomDouble();
+            }
+        }
+        static_a.emplace_back(a);
+        static_b.emplace_back(b);
+        dynamic_a.push_back(std::move(a));
+        dynamic_b.push_back(std::move(b));
+    }
+
+    const double dynamic = bench::SecondsPerRun([&] {
+        for (size_t n = 0; n < kCount; ++n) {
+            Matrix c = dynamic_a[n] * dynamic_b[n];
+            bench::DoNotOptimize(c);
+        }
+    });
+    const double fixed = bench::SecondsPerRun([&] {
+        for (size_t n = 0; n < kCount; ++n) {
+            StaticMatrixD<3, 3> c = static_a[n] * static_b[n];
+            bench::DoNotOptimize(c);
+        }
+    });
+
+    std::printf("%14s %16s\n", "type", "3x3 products/s");
+    std::printf("%14s %16.3e\n", "Matrix", kCount / dynamic);
+    std::printf("%14s %16.3e\n", "StaticMatrix", kCount / fixed);
+    std::printf("speedup: %.1fx\n", dynamic / fixed);
+    return 0;
+}
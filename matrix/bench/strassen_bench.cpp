@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "bench/bench.h"
+#include "src/gemm.h"
+#include "src/matrix.h"
+
+
+using task::Matrix;
+
+
+Matrix RandomMatrix(size_t n) {
+    Matrix temp(n, n);
+    for (size_t row = 0; row < n; ++row) {
+        for (size_t col = 0; col < n; ++col) {
+            temp[row][col] = bench::RandomDouble();
+        }
+    }
+    return temp;
+}
+
+
+// Square products through the blocked kernel and through one and two
+// levels of Strassen-Winograd, as effective GFLOP/s (2 n^3 / time), with
+// the largest deviation of the two-level result from the blocked one. The
+// crossover is the smallest tested order from which one level beats the
+// blocked kernel at every larger order; gemm::kStrassenCutoff should sit
+// near it.
+// Usage: strassen_bench [max_size]
+int main(int argc, char** argv) {
+    const size_t max_size = argc > 1 ? std::stoul(argv[1]) : 2048;
+
+    std::printf("kernel: %s, kStrassenCutoff = %zu\n", task::gemm::kernelName(),
+                task::gemm::kStrassenCutoff);
+    std::printf("%6s %14s %14s %14s %12s\n", "n", "blocked", "1 level", "2 levels", "max error");
+
+    size_t crossover = 0;
+    for (size_t n = 256; n <= max_size; n = n % 3 == 0 ? n / 3 * 4 : n / 2 * 3) {
+        const Matrix a = RandomMatrix(n);
+        const Matrix b = RandomMatrix(n);
+        Matrix blocked(n, n), strassen(n, n);
+        const size_t lda = a.getStride(), ldb = b.getStride(), ldc = blocked.getStride();
+        const double flops = 2.0 * n * n * n;
+
+        const auto run = [&](Matrix& c, size_t cutoff) {
+            return bench::SecondsPerRun([&] {
+                std::memset(c.data(), 0, n * ldc * sizeof(double));
+                if (cutoff == 0) {
+                    task::gemm::blocked(n, n, n, a.data(), lda, b.data(), ldb, c.data(), ldc);
+                } else {
+                    task::gemm::strassen(n, a.data(), lda, b.data(), ldb, c.data(), ldc, cutoff);
+                }
+                bench::DoNotOptimize(c);
+            });
+        };
+        const double classic = run(blocked, 0);
+        const double one_level = run(strassen, n);
+        const double two_levels = run(strassen, n / 2);
+
+        double error = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                error = std::max(error, std::fabs(strassen[i][j] - blocked[i][j]));
+            }
+        }
+        if (one_level >= classic) {
+            crossover = 0;
+        } else if (crossover == 0) {
+            crossover = n;
+        }
+
+        std::printf("%6zu %14.2f %14.2f %14.2f %12.2e\n", n, flops / classic * 1e-9,
+                    flops / one_level * 1e-9, flops / two_levels * 1e-9, error);
+    }
+    if (crossover == 0) {
+        std::printf("crossover: none up to %zu\n", max_size);
+    } else {
+        std::printf("crossover: n = %zu\n", crossover);
+    }
+    return 0;
+}
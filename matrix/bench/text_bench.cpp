@@ -0,0 +1,49 @@
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include "bench/bench.h"
+#include "src/matrix.h"
+#include "src/text_io.h"
+
+
+using task::Matrix;
+
+
+// Parsing throughput of the text format: iostream operator>> against
+// TextReader, both reading the same in-memory text.
+// Usage: text_bench [n]
+int main(int argc, char** argv) {
+    const size_t n = argc > 1 ? std::stoul(argv[1]) : 1024;
+
+    Matrix matrix(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            matrix[i][j] = bench::RandomDouble();
+        }
+    }
+    std::ostringstream output;
+    output.precision(17);
+    output << n << ' ' << n << '\n' << matrix;
+    const std::string text = output.str();
+    const double megabytes = text.size() / 1e6;
+
+    const double stream = bench::SecondsPerRun([&] {
+        std::istringstream input(text);
+        Matrix result;
+        input >> result;
+        bench::DoNotOptimize(result);
+    });
+    Matrix reused;
+    const double reader = bench::SecondsPerRun([&] {
+        std::istringstream input(text);
+        task::TextReader(input).read(reused);
+        bench::DoNotOptimize(reused);
+    });
+
+    std::printf("%zu x %zu doubles, %.1f MB of text\n", n, n, megabytes);
+    std::printf("%12s %10s %10s\n", "", "seconds", "MB/s");
+    std::printf("%12s %10.4f %10.1f\n", "operator>>", stream, megabytes / stream);
+    std::printf("%12s %10.4f %10.1f\n", "TextReader", reader, megabytes / reader);
+    std::printf("speedup: %.1fx\n", stream / reader);
+    return 0;
+}
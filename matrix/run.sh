@@ -3,8 +3,9 @@
 set -e
 
 STRESS_TEST_COUNT=500
+SOURCES="src/matrix.cpp src/gemm.cpp src/lu.cpp src/cholesky.cpp src/qr.cpp src/conjugate_gradient.cpp src/thread_pool.cpp src/sparse.cpp src/binary_io.cpp src/text_io.cpp src/batch.cpp src/profile.cpp src/pool.cpp"
 
-g++ -std=c++17 -I./ test/test.cpp src/matrix.cpp -o matrix_test
+g++ -std=c++17 -pthread -I./ test/test.cpp $SOURCES -o matrix_test
 python3 test/generate.py $STRESS_TEST_COUNT > test_data
 ./matrix_test $STRESS_TEST_COUNT < test_data
 
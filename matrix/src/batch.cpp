@@ -0,0 +1,447 @@
+#include "batch.h"
+#include "lu.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TASK_BATCH_X86 1
+#endif
+
+#ifdef __GNUC__
+#define TASK_BATCH_INLINE inline __attribute__((always_inline))
+#else
+#define TASK_BATCH_INLINE inline
+#endif
+
+using namespace task;
+
+namespace {
+
+#ifdef __GNUC__
+// MatrixBatch::kLanes doubles as one SIMD value: a single register with
+// AVX, a pair of SSE registers in the baseline build.
+typedef double Lanes __attribute__((vector_size(MatrixBatch::kLanes * sizeof(double))));
+#else
+using Lanes = double;
+#endif
+
+// Matrices processed per Lanes value.
+constexpr size_t kStep = sizeof(Lanes) / sizeof(double);
+
+// The kernels below are written once, always inlined into a baseline and
+// an AVX2 entry point, and only pass Lanes by reference so that both
+// copies agree on the calling convention.
+
+TASK_BATCH_INLINE void load(Lanes& value, const double* source) {
+  std::memcpy(&value, source, sizeof(Lanes));
+}
+
+TASK_BATCH_INLINE void store(double* target, const Lanes& value) {
+  std::memcpy(target, &value, sizeof(Lanes));
+}
+
+// Element e of the matrices in a chunk starts at chunk + e * kLanes.
+const size_t kLanes = MatrixBatch::kLanes;
+
+template <size_t N>
+TASK_BATCH_INLINE void loadSquare(Lanes (&a)[N][N], const double* chunk, size_t lane) {
+  for (size_t i = 0; i < N; ++i) {
+    for (size_t j = 0; j < N; ++j) {
+      load(a[i][j], chunk + (i * N + j) * kLanes + lane);
+    }
+  }
+}
+
+// c = a * b for the chunks [begin, end); a is rows x inner and b inner x
+// cols.
+TASK_BATCH_INLINE void multiplyChunks(const double* a, const double* b, double* c,
+                                      size_t rows, size_t inner, size_t cols,
+                                      size_t begin, size_t end) {
+  for (size_t chunk = begin; chunk < end; ++chunk) {
+    const double* x = a + chunk * rows * inner * kLanes;
+    const double* y = b + chunk * inner * cols * kLanes;
+    double* z = c + chunk * rows * cols * kLanes;
+    for (size_t lane = 0; lane < kLanes; lane += kStep) {
+      for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+          Lanes sum = {};
+          for (size_t p = 0; p < inner; ++p) {
+            Lanes left, right;
+            load(left, x + (i * inner + p) * kLanes + lane);
+            load(right, y + (p * cols + j) * kLanes + lane);
+            sum += left * right;
+          }
+          store(z + (i * cols + j) * kLanes + lane, sum);
+        }
+      }
+    }
+  }
+}
+
+// The 2x2 minors of the top (s) and bottom (c) row pairs of a 4x4 matrix,
+// as in StaticMatrix.
+struct Minors4 {
+  Lanes s0, s1, s2, s3, s4, s5;
+  Lanes c0, c1, c2, c3, c4, c5;
+};
+
+TASK_BATCH_INLINE void minors4(const Lanes (&a)[4][4], Minors4& m) {
+  m.s0 = a[0][0] * a[1][1] - a[1][0] * a[0][1];
+  m.s1 = a[0][0] * a[1][2] - a[1][0] * a[0][2];
+  m.s2 = a[0][0] * a[1][3] - a[1][0] * a[0][3];
+  m.s3 = a[0][1] * a[1][2] - a[1][1] * a[0][2];
+  m.s4 = a[0][1] * a[1][3] - a[1][1] * a[0][3];
+  m.s5 = a[0][2] * a[1][3] - a[1][2] * a[0][3];
+  m.c0 = a[2][0] * a[3][1] - a[3][0] * a[2][1];
+  m.c1 = a[2][0] * a[3][2] - a[3][0] * a[2][2];
+  m.c2 = a[2][0] * a[3][3] - a[3][0] * a[2][3];
+  m.c3 = a[2][1] * a[3][2] - a[3][1] * a[2][2];
+  m.c4 = a[2][1] * a[3][3] - a[3][1] * a[2][3];
+  m.c5 = a[2][2] * a[3][3] - a[3][2] * a[2][3];
+}
+
+template <size_t N>
+TASK_BATCH_INLINE void detSquare(const Lanes (&a)[N][N], Lanes& det) {
+  if constexpr (N == 1) {
+    det = a[0][0];
+  } else if constexpr (N == 2) {
+    det = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+  } else if constexpr (N == 3) {
+    det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+          a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+          a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+  } else {
+    Minors4 m;
+    minors4(a, m);
+    det = m.s0 * m.c5 - m.s1 * m.c4 + m.s2 * m.c3 +
+          m.s3 * m.c2 - m.s4 * m.c1 + m.s5 * m.c0;
+  }
+}
+
+// Adjugate over determinant; lanes with a zero determinant get infinities
+// and are reported through `det`.
+template <size_t N>
+TASK_BATCH_INLINE void inverseSquare(const Lanes (&a)[N][N], Lanes (&out)[N][N], Lanes& det) {
+  detSquare<N>(a, det);
+  const Lanes inv = 1.0 / det;
+  if constexpr (N == 1) {
+    out[0][0] = inv;
+  } else if constexpr (N == 2) {
+    out[0][0] = a[1][1] * inv;
+    out[0][1] = -a[0][1] * inv;
+    out[1][0] = -a[1][0] * inv;
+    out[1][1] = a[0][0] * inv;
+  } else if constexpr (N == 3) {
+    out[0][0] = (a[1][1] * a[2][2] - a[1][2] * a[2][1]) * inv;
+    out[0][1] = (a[0][2] * a[2][1] - a[0][1] * a[2][2]) * inv;
+    out[0][2] = (a[0][1] * a[1][2] - a[0][2] * a[1][1]) * inv;
+    out[1][0] = (a[1][2] * a[2][0] - a[1][0] * a[2][2]) * inv;
+    out[1][1] = (a[0][0] * a[2][2] - a[0][2] * a[2][0]) * inv;
+    out[1][2] = (a[0][2] * a[1][0] - a[0][0] * a[1][2]) * inv;
+    out[2][0] = (a[1][0] * a[2][1] - a[1][1] * a[2][0]) * inv;
+    out[2][1] = (a[0][1] * a[2][0] - a[0][0] * a[2][1]) * inv;
+    out[2][2] = (a[0][0] * a[1][1] - a[0][1] * a[1][0]) * inv;
+  } else {
+    Minors4 m;
+    minors4(a, m);
+    out[0][0] = ( a[1][1] * m.c5 - a[1][2] * m.c4 + a[1][3] * m.c3) * inv;
+    out[0][1] = (-a[0][1] * m.c5 + a[0][2] * m.c4 - a[0][3] * m.c3) * inv;
+    out[0][2] = ( a[3][1] * m.s5 - a[3][2] * m.s4 + a[3][3] * m.s3) * inv;
+    out[0][3] = (-a[2][1] * m.s5 + a[2][2] * m.s4 - a[2][3] * m.s3) * inv;
+    out[1][0] = (-a[1][0] * m.c5 + a[1][2] * m.c2 - a[1][3] * m.c1) * inv;
+    out[1][1] = ( a[0][0] * m.c5 - a[0][2] * m.c2 + a[0][3] * m.c1) * inv;
+    out[1][2] = (-a[3][0] * m.s5 + a[3][2] * m.s2 - a[3][3] * m.s1) * inv;
+    out[1][3] = ( a[2][0] * m.s5 - a[2][2] * m.s2 + a[2][3] * m.s1) * inv;
+    out[2][0] = ( a[1][0] * m.c4 - a[1][1] * m.c2 + a[1][3] * m.c0) * inv;
+    out[2][1] = (-a[0][0] * m.c4 + a[0][1] * m.c2 - a[0][3] * m.c0) * inv;
+    out[2][2] = ( a[3][0] * m.s4 - a[3][1] * m.s2 + a[3][3] * m.s0) * inv;
+    out[2][3] = (-a[2][0] * m.s4 + a[2][1] * m.s2 - a[2][3] * m.s0) * inv;
+    out[3][0] = (-a[1][0] * m.c3 + a[1][1] * m.c1 - a[1][2] * m.c0) * inv;
+    out[3][1] = ( a[0][0] * m.c3 - a[0][1] * m.c1 + a[0][2] * m.c0) * inv;
+    out[3][2] = (-a[3][0] * m.s3 + a[3][1] * m.s1 - a[3][2] * m.s0) * inv;
+    out[3][3] = ( a[2][0] * m.s3 - a[2][1] * m.s1 + a[2][2] * m.s0) * inv;
+  }
+}
+
+// det gets one value per matrix, kLanes per chunk.
+template <size_t N>
+TASK_BATCH_INLINE void detChunksOf(const double* a, double* det, size_t begin, size_t end) {
+  for (size_t chunk = begin; chunk < end; ++chunk) {
+    for (size_t lane = 0; lane < kLanes; lane += kStep) {
+      Lanes matrix[N][N], value;
+      loadSquare<N>(matrix, a + chunk * N * N * kLanes, lane);
+      detSquare<N>(matrix, value);
+      store(det + chunk * kLanes + lane, value);
+    }
+  }
+}
+
+template <size_t N>
+TASK_BATCH_INLINE void inverseChunksOf(const double* a, double* out, double* det,
+                                       size_t begin, size_t end) {
+  for (size_t chunk = begin; chunk < end; ++chunk) {
+    for (size_t lane = 0; lane < kLanes; lane += kStep) {
+      Lanes matrix[N][N], inverse[N][N], value;
+      loadSquare<N>(matrix, a + chunk * N * N * kLanes, lane);
+      inverseSquare<N>(matrix, inverse, value);
+      for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+          store(out + (chunk * N * N + i * N + j) * kLanes + lane, inverse[i][j]);
+        }
+      }
+      store(det + chunk * kLanes + lane, value);
+    }
+  }
+}
+
+// Determinants of n x n matrices, 1 <= n <= 4.
+TASK_BATCH_INLINE void detChunks(const double* a, double* det, size_t n,
+                                 size_t begin, size_t end) {
+  switch (n) {
+    case 1: return detChunksOf<1>(a, det, begin, end);
+    case 2: return detChunksOf<2>(a, det, begin, end);
+    case 3: return detChunksOf<3>(a, det, begin, end);
+    default: return detChunksOf<4>(a, det, begin, end);
+  }
+}
+
+TASK_BATCH_INLINE void inverseChunks(const double* a, double* out, double* det, size_t n,
+                                     size_t begin, size_t end) {
+  switch (n) {
+    case 1: return inverseChunksOf<1>(a, out, det, begin, end);
+    case 2: return inverseChunksOf<2>(a, out, det, begin, end);
+    case 3: return inverseChunksOf<3>(a, out, det, begin, end);
+    default: return inverseChunksOf<4>(a, out, det, begin, end);
+  }
+}
+
+// Largest size with a closed-form kernel.
+const size_t kClosedFormSize = 4;
+
+void multiplyBaseline(const double* a, const double* b, double* c,
+                      size_t rows, size_t inner, size_t cols, size_t begin, size_t end) {
+  multiplyChunks(a, b, c, rows, inner, cols, begin, end);
+}
+
+void detBaseline(const double* a, double* det, size_t n, size_t begin, size_t end) {
+  detChunks(a, det, n, begin, end);
+}
+
+void inverseBaseline(const double* a, double* out, double* det, size_t n,
+                     size_t begin, size_t end) {
+  inverseChunks(a, out, det, n, begin, end);
+}
+
+#ifdef TASK_BATCH_X86
+
+__attribute__((target("avx2,fma")))
+void multiplyAvx2(const double* a, const double* b, double* c,
+                  size_t rows, size_t inner, size_t cols, size_t begin, size_t end) {
+  multiplyChunks(a, b, c, rows, inner, cols, begin, end);
+}
+
+__attribute__((target("avx2,fma")))
+void detAvx2(const double* a, double* det, size_t n, size_t begin, size_t end) {
+  detChunks(a, det, n, begin, end);
+}
+
+__attribute__((target("avx2,fma")))
+void inverseAvx2(const double* a, double* out, double* det, size_t n,
+                 size_t begin, size_t end) {
+  inverseChunks(a, out, det, n, begin, end);
+}
+
+#endif  // TASK_BATCH_X86
+
+struct Kernels {
+  decltype(&multiplyBaseline) multiply;
+  decltype(&detBaseline) det;
+  decltype(&inverseBaseline) inverse;
+};
+
+Kernels selectKernels() {
+#ifdef TASK_BATCH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return {multiplyAvx2, detAvx2, inverseAvx2};
+  }
+#endif
+  return {multiplyBaseline, detBaseline, inverseBaseline};
+}
+
+const Kernels& kernels() {
+  static const Kernels selected = selectKernels();
+  return selected;
+}
+
+}  // namespace
+
+MatrixBatch::MatrixBatch(size_t count, size_t rows, size_t cols)
+    : count_(count), rows_(rows), cols_(cols),
+      data_((count + kLanes - 1) / kLanes * kLanes * rows * cols, 0.) {}
+
+Matrix MatrixBatch::getMatrix(size_t index) const {
+  if (index >= count_) {
+    throw OutOfBoundsException();
+  }
+  Matrix result(rows_, cols_);
+  for (size_t i = 0; i < rows_; ++i) {
+    for (size_t j = 0; j < cols_; ++j) {
+      result(i, j) = (*this)(index, i, j);
+    }
+  }
+  return result;
+}
+
+void MatrixBatch::setMatrix(size_t index, const Matrix& matrix) {
+  if (index >= count_) {
+    throw OutOfBoundsException();
+  }
+  if (matrix.getRows() != rows_ || matrix.getCols() != cols_) {
+    throw SizeMismatchException();
+  }
+  for (size_t i = 0; i < rows_; ++i) {
+    for (size_t j = 0; j < cols_; ++j) {
+      (*this)(index, i, j) = matrix(i, j);
+    }
+  }
+}
+
+MatrixBatch MatrixBatch::operator*(const MatrixBatch& other) const {
+  MatrixBatch result(0, 0, 0);
+  multiply(other, result);
+  return result;
+}
+
+MatrixBatch MatrixBatch::transposed() const {
+  MatrixBatch result(0, 0, 0);
+  transposed(result);
+  return result;
+}
+
+std::vector<double> MatrixBatch::det() const {
+  std::vector<double> result;
+  det(result);
+  return result;
+}
+
+MatrixBatch MatrixBatch::inverse() const {
+  MatrixBatch result(0, 0, 0);
+  inverse(result);
+  return result;
+}
+
+void MatrixBatch::multiply(const MatrixBatch& other, MatrixBatch& result) const {
+  if (count_ != other.count_ || cols_ != other.rows_) {
+    throw SizeMismatchException();
+  }
+  result.reshape(count_, rows_, other.cols_);
+  const auto multiply = kernels().multiply;
+  const size_t grain = chunkGrain(rows_ * cols_ * other.cols_);
+  parallel::forRange(chunks(), grain, [&](size_t begin, size_t end) {
+    multiply(data_.data(), other.data_.data(), result.data_.data(),
+             rows_, cols_, other.cols_, begin, end);
+  });
+}
+
+void MatrixBatch::transposed(MatrixBatch& result) const {
+  result.reshape(count_, cols_, rows_);
+  const size_t size = rows_ * cols_ * kLanes;
+  for (size_t chunk = 0; chunk < chunks(); ++chunk) {
+    const double* source = data_.data() + chunk * size;
+    double* target = result.data_.data() + chunk * size;
+    for (size_t i = 0; i < rows_; ++i) {
+      for (size_t j = 0; j < cols_; ++j) {
+        std::memcpy(target + (j * rows_ + i) * kLanes, source + (i * cols_ + j) * kLanes,
+                    kLanes * sizeof(double));
+      }
+    }
+  }
+}
+
+void MatrixBatch::det(std::vector<double>& result) const {
+  checkSquare();
+  result.resize(chunks() * kLanes);
+  if (rows_ != 0 && rows_ <= kClosedFormSize) {
+    const auto det = kernels().det;
+    const size_t grain = chunkGrain(rows_ * rows_ * rows_);
+    parallel::forRange(chunks(), grain, [&](size_t begin, size_t end) {
+      det(data_.data(), result.data(), rows_, begin, end);
+    });
+  } else {
+    parallel::forRange(count_, 1, [&](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        result[i] = LU(getMatrix(i)).det();
+      }
+    });
+  }
+  result.resize(count_);
+}
+
+void MatrixBatch::inverse(MatrixBatch& result) const {
+  checkSquare();
+  result.reshape(count_, rows_, cols_);
+  if (rows_ != 0 && rows_ <= kClosedFormSize) {
+    // Captured by the workers, so it cannot be thread_local.
+    std::vector<double> det(chunks() * kLanes);
+    const auto inverse = kernels().inverse;
+    const size_t grain = chunkGrain(rows_ * rows_ * rows_);
+    parallel::forRange(chunks(), grain, [&](size_t begin, size_t end) {
+      inverse(data_.data(), result.data_.data(), det.data(), rows_, begin, end);
+    });
+    if (std::find(det.begin(), det.begin() + count_, 0.) != det.begin() + count_) {
+      throw SingularMatrixException();
+    }
+    // Inverting the zero padding of the last chunk gave infinities.
+    for (size_t index = count_; index < chunks() * kLanes; ++index) {
+      for (size_t i = 0; i < rows_; ++i) {
+        for (size_t j = 0; j < cols_; ++j) {
+          result(index, i, j) = 0.;
+        }
+      }
+    }
+  } else {
+    for (size_t i = 0; i < count_; ++i) {
+      const LU lu(getMatrix(i));
+      if (lu.isSingular()) {
+        throw SingularMatrixException();
+      }
+      result.setMatrix(i, lu.inverse());
+    }
+  }
+}
+
+size_t MatrixBatch::size() const {
+  return count_;
+}
+
+size_t MatrixBatch::getRows() const {
+  return rows_;
+}
+
+size_t MatrixBatch::getCols() const {
+  return cols_;
+}
+
+size_t MatrixBatch::chunks() const {
+  return (count_ + kLanes - 1) / kLanes;
+}
+
+void MatrixBatch::reshape(size_t count, size_t rows, size_t cols) {
+  count_ = count;
+  rows_ = rows;
+  cols_ = cols;
+  data_.resize(chunks() * kLanes * rows * cols);
+}
+
+void MatrixBatch::checkSquare() const {
+  if (rows_ != cols_) {
+    throw SizeMismatchException();
+  }
+}
+
+size_t MatrixBatch::chunkGrain(size_t work) const {
+  return std::max<size_t>(1, parallel::kGrain / std::max<size_t>(1, work * kLanes));
+}
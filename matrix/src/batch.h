@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// size() matrices of one shape, stored structure-of-arrays in chunks of
+// kLanes matrices: within a chunk, element (i, j) of its kLanes matrices is
+// kLanes adjacent values, so the batched kernels process one matrix per
+// SIMD lane with plain vector loads, and a chunk stays contiguous in
+// memory. Meant for millions of small matrices, where allocating a Matrix
+// per item would cost more than the arithmetic.
+class MatrixBatch {
+
+public:
+
+    // Matrices per chunk, one per lane of the kernels' SIMD values.
+    static constexpr size_t kLanes = 4;
+
+    // All zeros; unlike Matrix(rows, cols) these are not identities.
+    MatrixBatch(size_t count, size_t rows, size_t cols);
+
+    // Element (row, col) of matrix `index`, unchecked.
+    double& operator()(size_t index, size_t row, size_t col) {
+        return data_[offset(index, row, col)];
+    }
+    const double& operator()(size_t index, size_t row, size_t col) const {
+        return data_[offset(index, row, col)];
+    }
+
+    // Copies matrix `index` out of or into the batch. Throw
+    // OutOfBoundsException for a bad index and SizeMismatchException for
+    // a matrix of another shape.
+    Matrix getMatrix(size_t index) const;
+    void setMatrix(size_t index, const Matrix& matrix);
+
+    // Pairwise products: result i is (*this)[i] * other[i].
+    MatrixBatch operator*(const MatrixBatch& other) const;
+    MatrixBatch transposed() const;
+    // Square matrices only. Closed forms vectorized across the batch up to
+    // 4x4, LU one matrix at a time above that.
+    std::vector<double> det() const;
+    // Throws SingularMatrixException if any of the matrices is singular.
+    MatrixBatch inverse() const;
+
+    // The same kernels writing into an existing batch (or vector), which
+    // is reshaped as needed. Reusing one output across calls saves
+    // allocating and page-faulting a fresh one each time, which for small
+    // matrices costs more than the arithmetic. `result` must not be an
+    // operand.
+    void multiply(const MatrixBatch& other, MatrixBatch& result) const;
+    void transposed(MatrixBatch& result) const;
+    void det(std::vector<double>& result) const;
+    void inverse(MatrixBatch& result) const;
+
+    size_t size() const;
+    size_t getRows() const;
+    size_t getCols() const;
+
+ private:
+
+    size_t offset(size_t index, size_t row, size_t col) const {
+        return ((index / kLanes * rows_ + row) * cols_ + col) * kLanes + index % kLanes;
+    }
+    size_t chunks() const;
+    // Gives this batch count x rows x cols matrices of unspecified values.
+    void reshape(size_t count, size_t rows, size_t cols);
+    void checkSquare() const;
+    // Chunks of kLanes matrices per parallel task, for kernels doing about
+    // `work` multiply-adds per matrix.
+    size_t chunkGrain(size_t work) const;
+
+    size_t count_;
+    size_t rows_;
+    size_t cols_;
+    std::vector<double> data_;
+
+};
+
+}  // namespace task
@@ -0,0 +1,278 @@
+#include "binary_io.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace task;
+
+namespace {
+
+uint64_t swapBytes(uint64_t value) {
+  return __builtin_bswap64(value);
+}
+
+uint32_t swapBytes(uint32_t value) {
+  return __builtin_bswap32(value);
+}
+
+// Reverses the bytes of every `word`-byte scalar in [data, data + size).
+void swapWords(char* data, size_t size, size_t word) {
+  for (size_t offset = 0; offset + word <= size; offset += word) {
+    std::reverse(data + offset, data + offset + word);
+  }
+}
+
+// Checks `header` against a file of `file_size` bytes holding elements of
+// type T and converts its fields to native byte order. Returns true when
+// the payload was written in the other byte order.
+template <class T>
+bool checkHeader(binary::FileHeader& header, uint64_t file_size) {
+  if (std::memcmp(header.magic, binary::kMagic, sizeof(binary::kMagic)) != 0) {
+    throw FormatException();
+  }
+  const bool swapped = header.byte_order != binary::kByteOrderMark;
+  if (swapped) {
+    if (swapBytes(header.byte_order) != binary::kByteOrderMark) {
+      throw FormatException();
+    }
+    header.version = swapBytes(header.version);
+    header.dtype = swapBytes(header.dtype);
+    header.header_size = swapBytes(header.header_size);
+    header.rows = swapBytes(header.rows);
+    header.cols = swapBytes(header.cols);
+    header.stride = swapBytes(header.stride);
+  }
+  if (header.version != binary::kVersion || header.dtype != binary::DType<T>::kCode ||
+      header.header_size < sizeof(binary::FileHeader) ||
+      header.header_size > file_size || header.stride < header.cols) {
+    throw FormatException();
+  }
+  // Rows of no columns take no payload, so nothing would bound their count.
+  if (header.cols == 0) {
+    header.rows = 0;
+  }
+  const uint64_t payload = (file_size - header.header_size) / sizeof(T);
+  if (header.stride != 0 && header.rows > payload / header.stride) {
+    throw FormatException();
+  }
+  return swapped;
+}
+
+}  // namespace
+
+template <class T>
+void BasicMatrix<T>::save(const std::string& path) const {
+  TASK_PROFILE_SCOPE(kWrite, 0);
+  BasicMatrixWriter<T> writer(path, rows_, cols_);
+  writer.write(*this);
+  writer.close();
+}
+
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::load(const std::string& path) {
+  TASK_PROFILE_SCOPE(kRead, 0);
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw IOException();
+  }
+  input.seekg(0, std::ios::end);
+  const uint64_t file_size = input.tellg();
+  input.seekg(0);
+
+  binary::FileHeader header;
+  if (!input.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    throw FormatException();
+  }
+  const bool swapped = checkHeader<T>(header, file_size);
+  input.seekg(header.header_size);
+
+  BasicMatrix result(0, 0);
+  result.rows_ = header.rows;
+  result.cols_ = header.cols;
+  result.stride_ = strideFor(result.cols_);
+  result.data_ = allocate(result.rows_ * result.stride_);
+  if (header.stride == result.stride_) {
+    input.read(reinterpret_cast<char*>(result.data_),
+               result.rows_ * result.stride_ * sizeof(T));
+  } else {
+    for (size_t i = 0; i < result.rows_ && input; ++i) {
+      input.read(reinterpret_cast<char*>(result.rowData(i)), result.cols_ * sizeof(T));
+      input.seekg((header.stride - result.cols_) * sizeof(T), std::ios::cur);
+    }
+  }
+  if (!input) {
+    throw IOException();
+  }
+
+  for (size_t i = 0; i < result.rows_; ++i) {
+    T* row = result.rowData(i);
+    if (swapped) {
+      swapWords(reinterpret_cast<char*>(row), result.cols_ * sizeof(T),
+                binary::DType<T>::kWordSize);
+    }
+    // The file's padding is not trusted to be zero.
+    std::fill_n(row + result.cols_, result.stride_ - result.cols_, T());
+  }
+  return result;
+}
+
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::mmap(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw IOException();
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    throw IOException();
+  }
+  const uint64_t file_size = info.st_size;
+  if (file_size < sizeof(binary::FileHeader)) {
+    ::close(fd);
+    throw FormatException();
+  }
+  void* base = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    throw IOException();
+  }
+
+  // From here on the destructor of `result` unmaps the file if we throw.
+  BasicMatrix result(0, 0);
+  result.mapping_ = base;
+  result.mapping_size_ = file_size;
+
+  binary::FileHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  // Only a payload in native order, aligned and laid out exactly like
+  // BasicMatrix's own storage can be used without copying.
+  if (checkHeader<T>(header, file_size) || header.header_size % kAlignment != 0 ||
+      header.stride != strideFor(header.cols)) {
+    throw FormatException();
+  }
+  result.rows_ = header.rows;
+  result.cols_ = header.cols;
+  result.stride_ = header.stride;
+  result.data_ = reinterpret_cast<T*>(static_cast<char*>(base) + header.header_size);
+  return result;
+}
+
+template <class T>
+bool BasicMatrix<T>::isMapped() const {
+  return mapping_ != nullptr;
+}
+
+template <class T>
+void BasicMatrix<T>::unmap() {
+  ::munmap(mapping_, mapping_size_);
+  mapping_ = nullptr;
+  mapping_size_ = 0;
+}
+
+template <class T>
+BasicMatrixWriter<T>::BasicMatrixWriter(const std::string& path, size_t rows, size_t cols)
+    : output_(path, std::ios::binary | std::ios::trunc), rows_(rows), cols_(cols),
+      stride_(BasicMatrix<T>::strideFor(cols)), written_(0) {
+  if (!output_) {
+    throw IOException();
+  }
+  binary::FileHeader header = {};
+  std::memcpy(header.magic, binary::kMagic, sizeof(binary::kMagic));
+  header.version = binary::kVersion;
+  header.dtype = binary::DType<T>::kCode;
+  header.byte_order = binary::kByteOrderMark;
+  header.header_size = sizeof(header);
+  header.rows = rows;
+  header.cols = cols;
+  header.stride = stride_;
+  writeBytes(&header, sizeof(header));
+}
+
+template <class T>
+BasicMatrixWriter<T>::~BasicMatrixWriter() {
+  if (output_.is_open()) {
+    output_.close();
+  }
+}
+
+template <class T>
+void BasicMatrixWriter<T>::writeRow(const T* values) {
+  if (written_ == rows_) {
+    throw OutOfBoundsException();
+  }
+  static const char padding[BasicMatrix<T>::kAlignment] = {};
+  writeBytes(values, cols_ * sizeof(T));
+  writeBytes(padding, (stride_ - cols_) * sizeof(T));
+  ++written_;
+}
+
+template <class T>
+void BasicMatrixWriter<T>::write(const BasicMatrix<T>& block) {
+  if (block.getCols() != cols_) {
+    throw SizeMismatchException();
+  }
+  if (block.getRows() > rows_ - written_) {
+    throw OutOfBoundsException();
+  }
+  // Same column count, same stride: the block's storage, padding included,
+  // is exactly the payload of its rows.
+  writeBytes(block.data(), block.getRows() * stride_ * sizeof(T));
+  written_ += block.getRows();
+}
+
+template <class T>
+void BasicMatrixWriter<T>::close() {
+  if (!output_.is_open()) {
+    return;
+  }
+  output_.close();
+  if (!output_ || written_ != rows_) {
+    throw IOException();
+  }
+}
+
+template <class T>
+size_t BasicMatrixWriter<T>::getRows() const {
+  return rows_;
+}
+
+template <class T>
+size_t BasicMatrixWriter<T>::getCols() const {
+  return cols_;
+}
+
+template <class T>
+size_t BasicMatrixWriter<T>::rowsWritten() const {
+  return written_;
+}
+
+template <class T>
+void BasicMatrixWriter<T>::writeBytes(const void* bytes, size_t size) {
+  output_.write(static_cast<const char*>(bytes), size);
+  if (!output_) {
+    throw IOException();
+  }
+}
+
+#define TASK_INSTANTIATE_BINARY_IO(T)                                              \
+  template void task::BasicMatrix<T>::save(const std::string&) const;              \
+  template BasicMatrix<T> task::BasicMatrix<T>::load(const std::string&);          \
+  template BasicMatrix<T> task::BasicMatrix<T>::mmap(const std::string&);          \
+  template bool task::BasicMatrix<T>::isMapped() const;                            \
+  template void task::BasicMatrix<T>::unmap();                                     \
+  template class task::BasicMatrixWriter<T>;
+
+TASK_INSTANTIATE_BINARY_IO(double)
+TASK_INSTANTIATE_BINARY_IO(float)
+TASK_INSTANTIATE_BINARY_IO(int64_t)
+TASK_INSTANTIATE_BINARY_IO(std::complex<double>)
+
+// The format has no dtype for Modular, but every matrix needs unmap() to
+// free its storage.
+template bool task::BasicMatrix<ModInt>::isMapped() const;
+template void task::BasicMatrix<ModInt>::unmap();
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include "matrix.h"
+
+
+namespace task {
+
+namespace binary {
+
+// File layout, version 1:
+//
+//   [0, header_size)   FileHeader, zero-padded
+//   [header_size, ...) rows * stride elements of the type named by dtype,
+//                      row-major; the last stride - cols values of every
+//                      row are zero
+//
+// All fields use the byte order of the machine that wrote the file; the
+// byte_order field tells a reader whether it has to swap. The payload
+// starts on a 64-byte boundary and rows use Matrix's own stride, so a file
+// written on a machine like this one can be mapped and used as is.
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t stride;
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader must stay 64 bytes");
+
+constexpr char kMagic[8] = {'T', 'M', 'A', 'T', 'R', 'I', 'X', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kFloat64 = 1;
+constexpr uint32_t kFloat32 = 2;
+constexpr uint32_t kInt64 = 3;
+constexpr uint32_t kComplex128 = 4;
+// Reads back as 0x04030201 on a machine of the other byte order.
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+// dtype code of an element type, and the size of the scalars a byte-order
+// swap reverses (a complex number swaps its two halves separately).
+template <class T>
+struct DType;
+
+template <>
+struct DType<double> {
+    static constexpr uint32_t kCode = kFloat64;
+    static constexpr size_t kWordSize = sizeof(double);
+};
+
+template <>
+struct DType<float> {
+    static constexpr uint32_t kCode = kFloat32;
+    static constexpr size_t kWordSize = sizeof(float);
+};
+
+template <>
+struct DType<int64_t> {
+    static constexpr uint32_t kCode = kInt64;
+    static constexpr size_t kWordSize = sizeof(int64_t);
+};
+
+template <>
+struct DType<std::complex<double>> {
+    static constexpr uint32_t kCode = kComplex128;
+    static constexpr size_t kWordSize = sizeof(double);
+};
+
+}  // namespace binary
+
+
+// Writes a matrix in the binary format a few rows at a time, so matrices
+// can be produced without ever holding all of them in memory. The shape
+// is fixed up front; close() throws IOException unless exactly `rows` rows
+// were written.
+template <class T>
+class BasicMatrixWriter {
+
+public:
+
+    BasicMatrixWriter(const std::string& path, size_t rows, size_t cols);
+    BasicMatrixWriter(const BasicMatrixWriter&) = delete;
+    BasicMatrixWriter& operator=(const BasicMatrixWriter&) = delete;
+    // Closes the file without checking, call close() to see errors.
+    ~BasicMatrixWriter();
+
+    // Appends one row of getCols() values.
+    void writeRow(const T* values);
+    // Appends all rows of `block`, which must have getCols() columns.
+    void write(const BasicMatrix<T>& block);
+    void close();
+
+    size_t getRows() const;
+    size_t getCols() const;
+    size_t rowsWritten() const;
+
+ private:
+
+    void writeBytes(const void* bytes, size_t size);
+
+    std::ofstream output_;
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    size_t written_;
+
+};
+
+using MatrixWriter = BasicMatrixWriter<double>;
+
+}  // namespace task
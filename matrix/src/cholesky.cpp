@@ -0,0 +1,185 @@
+#include "cholesky.h"
+#include "gemm.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace task;
+
+Cholesky::Cholesky(const Matrix& matrix)
+    : l_(matrix), n_(matrix.getRows()), positive_definite_(true) {
+  if (matrix.getRows() != matrix.getCols()) {
+    throw SizeMismatchException();
+  }
+  factorize();
+}
+
+// Right-looking blocked factorization: factorize a panel of kPanel columns
+// from the diagonal down, then subtract L21 * L21^T from the lower half of
+// the trailing submatrix, one block column of gemm at a time so the upper
+// half is never computed. gemm writes straight into l_.
+void Cholesky::factorize() {
+  double* data = l_.data();
+  const size_t stride = l_.getStride();
+  // -L21^T of the current block column, so gemm's C += A * B subtracts.
+  std::vector<double> negated(kPanel * kPanel);
+
+  for (size_t k = 0; k < n_ && positive_definite_; k += kPanel) {
+    const size_t width = std::min(kPanel, n_ - k);
+    factorizePanel(k, width);
+    const size_t start = k + width;
+    if (!positive_definite_ || start == n_) {
+      continue;
+    }
+    for (size_t j = start; j < n_; j += kPanel) {
+      const size_t block = std::min(kPanel, n_ - j);
+      for (size_t p = 0; p < width; ++p) {
+        double* out = negated.data() + p * block;
+        for (size_t c = 0; c < block; ++c) {
+          out[c] = -data[(j + c) * stride + k + p];
+        }
+      }
+      gemm::multiply(n_ - j, block, width, data + j * stride + k, stride,
+                     negated.data(), block, data + j * stride + j, stride);
+    }
+  }
+
+  for (size_t i = 0; i + 1 < n_; ++i) {
+    std::fill(data + i * stride + i + 1, data + i * stride + n_, 0.0);
+  }
+}
+
+// Left-looking factorization of columns [k, k + width), rows k and below:
+// each column first takes the updates of the panel columns before it.
+void Cholesky::factorizePanel(size_t k, size_t width) {
+  double* data = l_.data();
+  const size_t stride = l_.getStride();
+  for (size_t c = k; c < k + width; ++c) {
+    const double* pivot_row = data + c * stride;
+    double diagonal = pivot_row[c];
+    for (size_t p = k; p < c; ++p) {
+      diagonal -= pivot_row[p] * pivot_row[p];
+    }
+    if (!(diagonal > 0.0)) {
+      // Nothing left to compute: det() is 0 and solving throws.
+      positive_definite_ = false;
+      return;
+    }
+    diagonal = std::sqrt(diagonal);
+    data[c * stride + c] = diagonal;
+
+    // Every row below the diagonal is updated independently of the others.
+    const double inv_diagonal = 1.0 / diagonal;
+    const size_t grain = std::max<size_t>(1, parallel::kGrain / (c - k + 1));
+    parallel::forRange(n_ - c - 1, grain, [&](size_t begin, size_t end) {
+      for (size_t i = c + 1 + begin; i < c + 1 + end; ++i) {
+        double* row = data + i * stride;
+        double value = row[c];
+        for (size_t p = k; p < c; ++p) {
+          value -= row[p] * pivot_row[p];
+        }
+        row[c] = value * inv_diagonal;
+      }
+    });
+  }
+}
+
+double Cholesky::det() const {
+  if (!positive_definite_) {
+    return 0.0;
+  }
+  const double* data = l_.data();
+  const size_t stride = l_.getStride();
+  double result = 1.0;
+  for (size_t i = 0; i < n_; ++i) {
+    result *= data[i * stride + i] * data[i * stride + i];
+  }
+  return result;
+}
+
+bool Cholesky::isPositiveDefinite() const {
+  return positive_definite_;
+}
+
+// Overwrites the right-hand sides in x (n_ rows of `cols` values, `ldx`
+// apart) with the solution: forward substitution with L, then back
+// substitution with L^T, which reads L by columns.
+void Cholesky::substitute(double* x, size_t ldx, size_t cols) const {
+  if (!positive_definite_) {
+    throw SingularMatrixException();
+  }
+  const double* data = l_.data();
+  const size_t stride = l_.getStride();
+
+  for (size_t i = 0; i < n_; ++i) {
+    const double* lower = data + i * stride;
+    double* out = x + i * ldx;
+    for (size_t k = 0; k < i; ++k) {
+      const double factor = lower[k];
+      const double* solved = x + k * ldx;
+      for (size_t j = 0; j < cols; ++j) {
+        out[j] -= factor * solved[j];
+      }
+    }
+    const double inv_diagonal = 1.0 / lower[i];
+    for (size_t j = 0; j < cols; ++j) {
+      out[j] *= inv_diagonal;
+    }
+  }
+
+  // Row i of x is final once divided by L[i][i]; it is then scattered into
+  // the rows above it along row i of L, i.e. column i of L^T.
+  for (size_t i = n_; i-- > 0;) {
+    const double* lower = data + i * stride;
+    double* out = x + i * ldx;
+    const double inv_diagonal = 1.0 / lower[i];
+    for (size_t j = 0; j < cols; ++j) {
+      out[j] *= inv_diagonal;
+    }
+    for (size_t k = 0; k < i; ++k) {
+      const double factor = lower[k];
+      double* target = x + k * ldx;
+      for (size_t j = 0; j < cols; ++j) {
+        target[j] -= factor * out[j];
+      }
+    }
+  }
+}
+
+Matrix Cholesky::solve(const Matrix& b) const {
+  if (b.getRows() != n_) {
+    throw SizeMismatchException();
+  }
+  const size_t cols = b.getCols();
+  Matrix x(n_, cols);
+  for (size_t i = 0; i < n_; ++i) {
+    std::memcpy(x.data() + i * x.getStride(), b.data() + i * b.getStride(),
+                cols * sizeof(double));
+  }
+  substitute(x.data(), x.getStride(), cols);
+  return x;
+}
+
+std::vector<double> Cholesky::solve(const std::vector<double>& b) const {
+  if (b.size() != n_) {
+    throw SizeMismatchException();
+  }
+  std::vector<double> x(b);
+  substitute(x.data(), 1, 1);
+  return x;
+}
+
+Matrix Cholesky::inverse() const {
+  return solve(Matrix(n_, n_));
+}
+
+size_t Cholesky::size() const {
+  return n_;
+}
+
+const Matrix& Cholesky::factor() const {
+  return l_;
+}
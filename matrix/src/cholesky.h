@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// Cholesky factorization A = L * L^T of a symmetric positive definite
+// matrix. About half the work of LU and no pivoting; only the lower
+// triangle of A is read, so the upper one may hold anything.
+class Cholesky {
+
+public:
+
+    explicit Cholesky(const Matrix& matrix);
+
+    double det() const;
+    // False if a non-positive pivot turned up: the matrix is not positive
+    // definite (or not symmetric), and solving throws.
+    bool isPositiveDefinite() const;
+
+    Matrix solve(const Matrix& b) const;
+    std::vector<double> solve(const std::vector<double>& b) const;
+    Matrix inverse() const;
+
+    size_t size() const;
+
+    // L, with zeros above the diagonal. Incomplete unless
+    // isPositiveDefinite().
+    const Matrix& factor() const;
+
+ private:
+
+    // Columns per panel of the blocked factorization.
+    static constexpr size_t kPanel = 64;
+
+    void factorize();
+    void factorizePanel(size_t k, size_t width);
+    void substitute(double* x, size_t ldx, size_t cols) const;
+
+    Matrix l_;
+    size_t n_;
+    bool positive_definite_;
+
+};
+
+}  // namespace task
@@ -0,0 +1,143 @@
+#include "conjugate_gradient.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace task;
+
+namespace {
+
+double dot(const std::vector<double>& x, const std::vector<double>& y) {
+  double sum = 0.0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+// Dense matrix times vector, parallel over rows.
+void multiplyDense(const Matrix& a, const std::vector<double>& x, std::vector<double>& y) {
+  const size_t n = a.getCols();
+  const size_t grain = std::max<size_t>(1, parallel::kGrain / std::max<size_t>(n, 1));
+  parallel::forRange(a.getRows(), grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const double* row = a.data() + i * a.getStride();
+      double sum = 0.0;
+      for (size_t j = 0; j < n; ++j) {
+        sum += row[j] * x[j];
+      }
+      y[i] = sum;
+    }
+  });
+}
+
+}  // namespace
+
+ConjugateGradientResult task::conjugateGradient(const Matrix& a, const std::vector<double>& b,
+                                                const ConjugateGradientOptions& options) {
+  if (a.getRows() != a.getCols() || b.size() != a.getRows()) {
+    throw SizeMismatchException();
+  }
+  std::vector<double> diagonal;
+  if (options.jacobi) {
+    diagonal.resize(a.getRows());
+    for (size_t i = 0; i < diagonal.size(); ++i) {
+      diagonal[i] = a(i, i);
+    }
+  }
+  const LinearOperator multiply = [&a](const std::vector<double>& x, std::vector<double>& y) {
+    multiplyDense(a, x, y);
+  };
+  return conjugateGradient(multiply, diagonal, b, options);
+}
+
+ConjugateGradientResult task::conjugateGradient(const SparseMatrix& a,
+                                                const std::vector<double>& b,
+                                                const ConjugateGradientOptions& options) {
+  if (a.getRows() != a.getCols() || b.size() != a.getRows()) {
+    throw SizeMismatchException();
+  }
+  std::vector<double> diagonal;
+  if (options.jacobi) {
+    diagonal.resize(a.getRows());
+    for (size_t i = 0; i < diagonal.size(); ++i) {
+      diagonal[i] = a.get(i, i);
+    }
+  }
+  const LinearOperator multiply = [&a](const std::vector<double>& x, std::vector<double>& y) {
+    a.multiply(x, y);
+  };
+  return conjugateGradient(multiply, diagonal, b, options);
+}
+
+ConjugateGradientResult task::conjugateGradient(const LinearOperator& a,
+                                                const std::vector<double>& diagonal,
+                                                const std::vector<double>& b,
+                                                const ConjugateGradientOptions& options) {
+  const size_t n = b.size();
+  if (!diagonal.empty() && diagonal.size() != n) {
+    throw SizeMismatchException();
+  }
+  const size_t max_iterations = options.max_iterations != 0 ? options.max_iterations : 2 * n;
+
+  // A non-positive diagonal element means A is not positive definite;
+  // leave that row unscaled and let the iteration find out.
+  std::vector<double> inverse_diagonal(diagonal.size());
+  for (size_t i = 0; i < diagonal.size(); ++i) {
+    inverse_diagonal[i] = diagonal[i] > 0.0 ? 1.0 / diagonal[i] : 1.0;
+  }
+  const auto precondition = [&](const std::vector<double>& r, std::vector<double>& z) {
+    if (inverse_diagonal.empty()) {
+      z = r;
+      return;
+    }
+    for (size_t i = 0; i < n; ++i) {
+      z[i] = r[i] * inverse_diagonal[i];
+    }
+  };
+
+  ConjugateGradientResult result;
+  result.x.assign(n, 0.0);
+  const double b_norm = std::sqrt(dot(b, b));
+  if (b_norm == 0.0) {
+    result.converged = true;
+    return result;
+  }
+
+  std::vector<double> r(b), z(n), p(n), q(n);
+  precondition(r, z);
+  p = z;
+  double rz = dot(r, z);
+  result.residual = 1.0;
+  while (result.iterations < max_iterations) {
+    a(p, q);
+    if (q.size() != n) {
+      throw SizeMismatchException();
+    }
+    const double curvature = dot(p, q);
+    if (!(curvature > 0.0)) {
+      break;
+    }
+    const double alpha = rz / curvature;
+    for (size_t i = 0; i < n; ++i) {
+      result.x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+    }
+    ++result.iterations;
+    result.residual = std::sqrt(dot(r, r)) / b_norm;
+    if (result.residual <= options.tolerance) {
+      result.converged = true;
+      break;
+    }
+
+    precondition(r, z);
+    const double next_rz = dot(r, z);
+    const double beta = next_rz / rz;
+    rz = next_rz;
+    for (size_t i = 0; i < n; ++i) {
+      p[i] = z[i] + beta * p[i];
+    }
+  }
+  return result;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "matrix.h"
+#include "sparse.h"
+
+
+namespace task {
+
+// y = A x for a square operator; y already has the right size. Lets the
+// solver run on anything that can multiply a vector, matrix-free included.
+using LinearOperator =
+    std::function<void(const std::vector<double>& x, std::vector<double>& y)>;
+
+struct ConjugateGradientOptions {
+    // Stop once |b - A x| <= tolerance * |b|.
+    double tolerance = 1e-10;
+    // 0 means twice the size of the system: exact arithmetic needs at most
+    // the size, rounding a little more.
+    size_t max_iterations = 0;
+    // Precondition with the inverse of the diagonal of A (Jacobi). Costs
+    // one multiplication per element and iteration, and on badly scaled
+    // systems saves many iterations.
+    bool jacobi = true;
+};
+
+struct ConjugateGradientResult {
+    std::vector<double> x;
+    size_t iterations = 0;
+    // |b - A x| / |b| when the iteration stopped.
+    double residual = 0.;
+    // False if max_iterations ran out first, or A turned out not to be
+    // positive definite.
+    bool converged = false;
+};
+
+// Preconditioned conjugate gradient for A x = b with A symmetric positive
+// definite, starting from x = 0. Each iteration costs one product with A
+// plus O(n), so it beats a factorization when A is sparse or the system is
+// well conditioned. Throws SizeMismatchException if A is not square or b
+// does not match it.
+ConjugateGradientResult conjugateGradient(const Matrix& a, const std::vector<double>& b,
+                                          const ConjugateGradientOptions& options = {});
+ConjugateGradientResult conjugateGradient(const SparseMatrix& a, const std::vector<double>& b,
+                                          const ConjugateGradientOptions& options = {});
+// `diagonal` is the diagonal of A for the Jacobi preconditioner; leave it
+// empty to go without one.
+ConjugateGradientResult conjugateGradient(const LinearOperator& a,
+                                          const std::vector<double>& diagonal,
+                                          const std::vector<double>& b,
+                                          const ConjugateGradientOptions& options = {});
+
+}  // namespace task
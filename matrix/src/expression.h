@@ -0,0 +1,438 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <type_traits>
+#include "thread_pool.h"
+
+
+// Expression templates for element-wise Matrix arithmetic. `a + b - c * 2.0`
+// builds a small tree of nodes instead of temporaries; the whole tree is
+// evaluated in one fused loop when it is assigned to (or used to construct)
+// a matrix. Operand sizes are still checked eagerly, when the node is built.
+//
+// Nodes refer to their Matrix operands, they do not copy them: an
+// expression must be evaluated before the matrices it mentions are gone.
+// This header is included at the end of matrix.h.
+
+
+namespace task {
+
+// Base of every expression node. A node E provides getRows(), getCols()
+// and row(i), which returns something indexable by column, plus
+// kOperations, the arithmetic operations it does per element (for the
+// profiler's FLOP counts), and overlaps(begin, end), whether it reads
+// any element stored in [begin, end) through a view.
+template <class E>
+class MatrixExpression {
+public:
+    const E& self() const { return static_cast<const E&>(*this); }
+
+    size_t getRows() const { return self().getRows(); }
+    size_t getCols() const { return self().getCols(); }
+};
+
+
+// Leaf node wrapping a matrix.
+template <class T>
+class MatrixRef : public MatrixExpression<MatrixRef<T>> {
+public:
+    using value_type = T;
+
+    static constexpr size_t kOperations = 0;
+
+    explicit MatrixRef(const BasicMatrix<T>& matrix) : matrix_(matrix) {}
+
+    size_t getRows() const { return matrix_.getRows(); }
+    size_t getCols() const { return matrix_.getCols(); }
+    const T* row(size_t i) const {
+        return matrix_.data() + i * matrix_.getStride();
+    }
+    // A whole matrix is only ever read element for element into a matrix
+    // of its own size, so it is safe even when it is the destination.
+    bool overlaps(const void*, const void*) const { return false; }
+
+private:
+    const BasicMatrix<T>& matrix_;
+};
+
+
+template <class T>
+struct IsMatrixExpression : std::is_base_of<MatrixExpression<T>, T> {};
+
+// Views are expressions too, but products treat them like matrices, see
+// matrix_view.h.
+template <class T>
+struct IsMatrixView : std::false_type {};
+
+template <class T>
+struct IsMatrixView<BasicMatrixView<T>> : std::true_type {};
+
+template <class T>
+struct IsLazyExpression
+    : std::bool_constant<IsMatrixExpression<T>::value && !IsMatrixView<T>::value> {};
+
+// Maps an operand type to the node stored for it inside an expression.
+template <class T, class = void>
+struct ExpressionOperand {};
+
+template <class T>
+struct ExpressionOperand<BasicMatrix<T>> {
+    using type = MatrixRef<T>;
+    static MatrixRef<T> wrap(const BasicMatrix<T>& matrix) { return MatrixRef<T>(matrix); }
+};
+
+template <class E>
+struct ExpressionOperand<E, std::enable_if_t<IsMatrixExpression<E>::value>> {
+    using type = E;
+    static const E& wrap(const E& expression) { return expression; }
+};
+
+template <class T, class = void>
+struct IsMatrixOperand : std::false_type {};
+
+template <class T>
+struct IsMatrixOperand<T, std::void_t<typename ExpressionOperand<T>::type>>
+    : std::true_type {};
+
+template <class T>
+using OperandType = typename ExpressionOperand<T>::type;
+
+// Element type of an operand.
+template <class T>
+using ValueType = typename OperandType<T>::value_type;
+
+template <class T>
+OperandType<T> asOperand(const T& value) {
+    return ExpressionOperand<T>::wrap(value);
+}
+
+
+struct PlusOp {
+    template <class T>
+    static T apply(const T& a, const T& b) { return a + b; }
+};
+
+struct MinusOp {
+    template <class T>
+    static T apply(const T& a, const T& b) { return a - b; }
+};
+
+
+template <class Op, class L, class R>
+class BinaryExpression : public MatrixExpression<BinaryExpression<Op, L, R>> {
+public:
+    using value_type = typename L::value_type;
+
+    static_assert(std::is_same_v<value_type, typename R::value_type>,
+                  "Operands of an element-wise expression need the same element type");
+
+    static constexpr size_t kOperations = 1 + L::kOperations + R::kOperations;
+
+    class Row {
+    public:
+        Row(const L& lhs, const R& rhs, size_t i) : lhs_(lhs.row(i)), rhs_(rhs.row(i)) {}
+
+        value_type operator[](size_t j) const {
+            return Op::template apply<value_type>(lhs_[j], rhs_[j]);
+        }
+
+    private:
+        decltype(std::declval<const L&>().row(0)) lhs_;
+        decltype(std::declval<const R&>().row(0)) rhs_;
+    };
+
+    BinaryExpression(const L& lhs, const R& rhs) : lhs_(lhs), rhs_(rhs) {
+        if (lhs.getRows() != rhs.getRows() || lhs.getCols() != rhs.getCols()) {
+            throw SizeMismatchException();
+        }
+    }
+
+    size_t getRows() const { return lhs_.getRows(); }
+    size_t getCols() const { return lhs_.getCols(); }
+    Row row(size_t i) const { return Row(lhs_, rhs_, i); }
+    bool overlaps(const void* begin, const void* end) const {
+        return lhs_.overlaps(begin, end) || rhs_.overlaps(begin, end);
+    }
+
+private:
+    L lhs_;
+    R rhs_;
+};
+
+
+template <class E>
+class ScaledExpression : public MatrixExpression<ScaledExpression<E>> {
+public:
+    using value_type = typename E::value_type;
+
+    static constexpr size_t kOperations = 1 + E::kOperations;
+
+    class Row {
+    public:
+        Row(const E& expression, size_t i, const value_type& factor)
+            : row_(expression.row(i)), factor_(factor) {}
+
+        value_type operator[](size_t j) const { return row_[j] * factor_; }
+
+    private:
+        decltype(std::declval<const E&>().row(0)) row_;
+        value_type factor_;
+    };
+
+    ScaledExpression(const E& expression, const value_type& factor)
+        : expression_(expression), factor_(factor) {}
+
+    size_t getRows() const { return expression_.getRows(); }
+    size_t getCols() const { return expression_.getCols(); }
+    Row row(size_t i) const { return Row(expression_, i, factor_); }
+    bool overlaps(const void* begin, const void* end) const {
+        return expression_.overlaps(begin, end);
+    }
+
+private:
+    E expression_;
+    value_type factor_;
+};
+
+
+template <class E>
+class NegatedExpression : public MatrixExpression<NegatedExpression<E>> {
+public:
+    using value_type = typename E::value_type;
+
+    static constexpr size_t kOperations = 1 + E::kOperations;
+
+    class Row {
+    public:
+        Row(const E& expression, size_t i) : row_(expression.row(i)) {}
+
+        value_type operator[](size_t j) const { return -row_[j]; }
+
+    private:
+        decltype(std::declval<const E&>().row(0)) row_;
+    };
+
+    explicit NegatedExpression(const E& expression) : expression_(expression) {}
+
+    size_t getRows() const { return expression_.getRows(); }
+    size_t getCols() const { return expression_.getCols(); }
+    Row row(size_t i) const { return Row(expression_, i); }
+    bool overlaps(const void* begin, const void* end) const {
+        return expression_.overlaps(begin, end);
+    }
+
+private:
+    E expression_;
+};
+
+
+template <class L, class R>
+using EnableIfOperands =
+    std::enable_if_t<IsMatrixOperand<L>::value && IsMatrixOperand<R>::value>;
+
+template <class L, class R, class = EnableIfOperands<L, R>>
+BinaryExpression<PlusOp, OperandType<L>, OperandType<R>>
+operator+(const L& lhs, const R& rhs) {
+    return {asOperand(lhs), asOperand(rhs)};
+}
+
+template <class L, class R, class = EnableIfOperands<L, R>>
+BinaryExpression<MinusOp, OperandType<L>, OperandType<R>>
+operator-(const L& lhs, const R& rhs) {
+    return {asOperand(lhs), asOperand(rhs)};
+}
+
+template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+ScaledExpression<OperandType<E>> operator*(const E& expression, const ValueType<E>& factor) {
+    return {asOperand(expression), factor};
+}
+
+template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+ScaledExpression<OperandType<E>> operator*(const ValueType<E>& factor, const E& expression) {
+    return {asOperand(expression), factor};
+}
+
+template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+NegatedExpression<OperandType<E>> operator-(const E& expression) {
+    return NegatedExpression<OperandType<E>>(asOperand(expression));
+}
+
+template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+OperandType<E> operator+(const E& expression) {
+    return asOperand(expression);
+}
+
+// A temporary Matrix operand lends its storage to the result instead of
+// being wrapped into a node that would outlive it.
+template <class T, class R, class = std::enable_if_t<IsMatrixOperand<R>::value>>
+BasicMatrix<T> operator+(BasicMatrix<T>&& lhs, const R& rhs) {
+    lhs += rhs;
+    return std::move(lhs);
+}
+
+template <class L, class T, class = std::enable_if_t<IsMatrixOperand<L>::value>>
+BasicMatrix<T> operator+(const L& lhs, BasicMatrix<T>&& rhs) {
+    rhs += lhs;
+    return std::move(rhs);
+}
+
+template <class T, class R, class = std::enable_if_t<IsMatrixOperand<R>::value>>
+BasicMatrix<T> operator-(BasicMatrix<T>&& lhs, const R& rhs) {
+    lhs -= rhs;
+    return std::move(lhs);
+}
+
+template <class L, class T, class = std::enable_if_t<IsMatrixOperand<L>::value>>
+BasicMatrix<T> operator-(const L& lhs, BasicMatrix<T>&& rhs) {
+    const BasicMatrix<T>& result = rhs;
+    rhs = lhs - result;
+    return std::move(rhs);
+}
+
+// Matrix products are not element-wise: lazy operands are evaluated first.
+template <class E, class = std::enable_if_t<IsLazyExpression<E>::value>>
+BasicMatrix<ValueType<E>> operator*(const E& lhs, const BasicMatrix<ValueType<E>>& rhs) {
+    return BasicMatrix<ValueType<E>>(lhs) * rhs;
+}
+
+template <class E, class = std::enable_if_t<IsLazyExpression<E>::value>>
+BasicMatrix<ValueType<E>> operator*(const BasicMatrix<ValueType<E>>& lhs, const E& rhs) {
+    return lhs * BasicMatrix<ValueType<E>>(rhs);
+}
+
+template <class L, class R, class = std::enable_if_t<IsLazyExpression<L>::value &&
+                                                     IsLazyExpression<R>::value>>
+BasicMatrix<ValueType<L>> operator*(const L& lhs, const R& rhs) {
+    return BasicMatrix<ValueType<L>>(lhs) * BasicMatrix<ValueType<R>>(rhs);
+}
+
+// Equality involving at least one lazy operand, compared without
+// materializing it; same semantics as BasicMatrix::operator==.
+template <class L, class R, class = std::enable_if_t<
+    IsMatrixOperand<L>::value && IsMatrixOperand<R>::value &&
+    (IsMatrixExpression<L>::value || IsMatrixExpression<R>::value)>>
+bool operator==(const L& lhs, const R& rhs) {
+    const OperandType<L> left = asOperand(lhs);
+    const OperandType<R> right = asOperand(rhs);
+    if (left.getRows() != right.getRows() || left.getCols() != right.getCols()) {
+        throw SizeMismatchException();
+    }
+    for (size_t i = 0; i < left.getRows(); ++i) {
+        const auto left_row = left.row(i);
+        const auto right_row = right.row(i);
+        for (size_t j = 0; j < left.getCols(); ++j) {
+            if (!ElementTraits<ValueType<L>>::equal(left_row[j], right_row[j])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <class L, class R, class = std::enable_if_t<
+    IsMatrixOperand<L>::value && IsMatrixOperand<R>::value &&
+    (IsMatrixExpression<L>::value || IsMatrixExpression<R>::value)>>
+bool operator!=(const L& lhs, const R& rhs) {
+    return !(lhs == rhs);
+}
+
+
+template <class T>
+template <class E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpression<E>& expression)
+    : rows_(expression.getRows()), cols_(expression.getCols()),
+      stride_(strideFor(expression.getCols())) {
+    TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_ * E::kOperations);
+    data_ = allocate(rows_ * stride_);
+    for (size_t i = 0; i < rows_; ++i) {
+        std::fill_n(rowData(i) + cols_, stride_ - cols_, T());
+    }
+    assign(expression.self());
+}
+
+template <class T>
+template <class E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const MatrixExpression<E>& expression) {
+    // A view of this matrix may be shifted or transposed relative to it,
+    // or gone once a resize frees the storage: evaluate into new storage.
+    if (expression.self().overlaps(data_, data_ + rows_ * stride_)) {
+        return *this = BasicMatrix(expression);
+    }
+    TASK_PROFILE_SCOPE(kElementwise,
+                       uint64_t(expression.getRows()) * expression.getCols() * E::kOperations);
+    if (rows_ != expression.getRows() || cols_ != expression.getCols()) {
+        freeSpace();
+        rows_ = expression.getRows();
+        cols_ = expression.getCols();
+        stride_ = strideFor(cols_);
+        allocSpace();
+    }
+    assign(expression.self());
+    return *this;
+}
+
+template <class T>
+template <class E>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const MatrixExpression<E>& expression) {
+    if (rows_ != expression.getRows() || cols_ != expression.getCols()) {
+        throw SizeMismatchException();
+    }
+    if (expression.self().overlaps(data_, data_ + rows_ * stride_)) {
+        return *this += BasicMatrix(expression);
+    }
+    TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_ * (E::kOperations + 1));
+    const E& source = expression.self();
+    parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            T* out = rowData(i);
+            const auto row = source.row(i);
+            for (size_t j = 0; j < cols_; ++j) {
+                out[j] += row[j];
+            }
+        }
+    });
+    return *this;
+}
+
+template <class T>
+template <class E>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const MatrixExpression<E>& expression) {
+    if (rows_ != expression.getRows() || cols_ != expression.getCols()) {
+        throw SizeMismatchException();
+    }
+    if (expression.self().overlaps(data_, data_ + rows_ * stride_)) {
+        return *this -= BasicMatrix(expression);
+    }
+    TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_ * (E::kOperations + 1));
+    const E& source = expression.self();
+    parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            T* out = rowData(i);
+            const auto row = source.row(i);
+            for (size_t j = 0; j < cols_; ++j) {
+                out[j] -= row[j];
+            }
+        }
+    });
+    return *this;
+}
+
+template <class T>
+template <class E>
+void BasicMatrix<T>::assign(const E& expression) {
+    static_assert(std::is_same_v<T, typename E::value_type>,
+                  "Expression and matrix need the same element type");
+    parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            T* out = rowData(i);
+            const auto row = expression.row(i);
+            for (size_t j = 0; j < cols_; ++j) {
+                out[j] = row[j];
+            }
+        }
+    });
+}
+
+}  // namespace task
@@ -0,0 +1,632 @@
+#include "gemm.h"
+#include "modular.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TASK_GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+
+namespace task {
+namespace gemm {
+
+namespace {
+
+const size_t kBufferAlignment = 64;
+
+// Register tile of the micro-kernel for T: kRows x kCols elements of C.
+template <class T>
+struct Tile {
+  static constexpr size_t kRows = kMR;
+  static constexpr size_t kCols = kNR;
+};
+
+template <>
+struct Tile<float> {
+  static constexpr size_t kRows = kMR;
+  static constexpr size_t kCols = 2 * kNR;
+};
+
+// Columns of C per parallel task, and packed B panels per packing task.
+template <class T>
+constexpr size_t kNG = 16 * Tile<T>::kCols;
+const size_t kPackGrain = 16;
+
+template <class T>
+using MicroKernel = void (*)(size_t kc, const T* a, const T* b, T* c, size_t ldc);
+
+// Grow-only aligned scratch space for packed panels, one per thread.
+template <class T>
+class PackBuffer {
+ public:
+  PackBuffer() : data_(nullptr), capacity_(0) {}
+  PackBuffer(const PackBuffer&) = delete;
+  PackBuffer& operator=(const PackBuffer&) = delete;
+
+  ~PackBuffer() {
+    release();
+  }
+
+  T* reserve(size_t count) {
+    if (count > capacity_) {
+      release();
+      data_ = static_cast<T*>(::operator new(
+          count * sizeof(T), std::align_val_t(kBufferAlignment)));
+      capacity_ = count;
+    }
+    return data_;
+  }
+
+ private:
+  void release() {
+    if (data_ != nullptr) {
+      ::operator delete(data_, std::align_val_t(kBufferAlignment));
+      data_ = nullptr;
+      capacity_ = 0;
+    }
+  }
+
+  T* data_;
+  size_t capacity_;
+};
+
+template <class T>
+void scalarKernel(size_t kc, const T* a, const T* b, T* c, size_t ldc) {
+  constexpr size_t kRows = Tile<T>::kRows;
+  constexpr size_t kCols = Tile<T>::kCols;
+  T acc[kRows][kCols] = {};
+  for (size_t p = 0; p < kc; ++p) {
+    for (size_t i = 0; i < kRows; ++i) {
+      const T factor = a[i];
+      for (size_t j = 0; j < kCols; ++j) {
+        acc[i][j] += factor * b[j];
+      }
+    }
+    a += kRows;
+    b += kCols;
+  }
+  for (size_t i = 0; i < kRows; ++i) {
+    for (size_t j = 0; j < kCols; ++j) {
+      c[i * ldc + j] += acc[i][j];
+    }
+  }
+}
+
+#ifdef TASK_GEMM_X86
+
+__attribute__((target("avx2,fma")))
+void avx2Kernel(size_t kc, const double* a, const double* b,
+                double* c, size_t ldc) {
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  for (size_t p = 0; p < kc; ++p) {
+    const __m256d b0 = _mm256_load_pd(b);
+    const __m256d b1 = _mm256_load_pd(b + 4);
+    __m256d factor = _mm256_broadcast_sd(a);
+    c00 = _mm256_fmadd_pd(factor, b0, c00);
+    c01 = _mm256_fmadd_pd(factor, b1, c01);
+    factor = _mm256_broadcast_sd(a + 1);
+    c10 = _mm256_fmadd_pd(factor, b0, c10);
+    c11 = _mm256_fmadd_pd(factor, b1, c11);
+    factor = _mm256_broadcast_sd(a + 2);
+    c20 = _mm256_fmadd_pd(factor, b0, c20);
+    c21 = _mm256_fmadd_pd(factor, b1, c21);
+    factor = _mm256_broadcast_sd(a + 3);
+    c30 = _mm256_fmadd_pd(factor, b0, c30);
+    c31 = _mm256_fmadd_pd(factor, b1, c31);
+    a += kMR;
+    b += kNR;
+  }
+  double* row = c;
+  _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c00));
+  _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c01));
+  row += ldc;
+  _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c10));
+  _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c11));
+  row += ldc;
+  _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c20));
+  _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c21));
+  row += ldc;
+  _mm256_storeu_pd(row, _mm256_add_pd(_mm256_loadu_pd(row), c30));
+  _mm256_storeu_pd(row + 4, _mm256_add_pd(_mm256_loadu_pd(row + 4), c31));
+}
+
+// Same 4-row tile as the double kernel, with 16 floats per row.
+__attribute__((target("avx2,fma")))
+void avx2Kernel(size_t kc, const float* a, const float* b,
+                float* c, size_t ldc) {
+  __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+  __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+  __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+  __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+  for (size_t p = 0; p < kc; ++p) {
+    const __m256 b0 = _mm256_load_ps(b);
+    const __m256 b1 = _mm256_load_ps(b + 8);
+    __m256 factor = _mm256_broadcast_ss(a);
+    c00 = _mm256_fmadd_ps(factor, b0, c00);
+    c01 = _mm256_fmadd_ps(factor, b1, c01);
+    factor = _mm256_broadcast_ss(a + 1);
+    c10 = _mm256_fmadd_ps(factor, b0, c10);
+    c11 = _mm256_fmadd_ps(factor, b1, c11);
+    factor = _mm256_broadcast_ss(a + 2);
+    c20 = _mm256_fmadd_ps(factor, b0, c20);
+    c21 = _mm256_fmadd_ps(factor, b1, c21);
+    factor = _mm256_broadcast_ss(a + 3);
+    c30 = _mm256_fmadd_ps(factor, b0, c30);
+    c31 = _mm256_fmadd_ps(factor, b1, c31);
+    a += Tile<float>::kRows;
+    b += Tile<float>::kCols;
+  }
+  float* row = c;
+  _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), c00));
+  _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), c01));
+  row += ldc;
+  _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), c10));
+  _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), c11));
+  row += ldc;
+  _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), c20));
+  _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), c21));
+  row += ldc;
+  _mm256_storeu_ps(row, _mm256_add_ps(_mm256_loadu_ps(row), c30));
+  _mm256_storeu_ps(row + 8, _mm256_add_ps(_mm256_loadu_ps(row + 8), c31));
+}
+
+#endif  // TASK_GEMM_X86
+
+bool hasAvx2Fma() {
+#ifdef TASK_GEMM_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+  return false;
+#endif
+}
+
+// Vector kernels exist for double and float only; every other type runs
+// the scalar kernel.
+template <class T>
+MicroKernel<T> selectKernel() {
+#ifdef TASK_GEMM_X86
+  if constexpr (std::is_same_v<T, double> || std::is_same_v<T, float>) {
+    if (hasAvx2Fma()) {
+      return avx2Kernel;
+    }
+  }
+#endif
+  return scalarKernel<T>;
+}
+
+template <class T>
+MicroKernel<T> microKernel() {
+  static const MicroKernel<T> kernel = selectKernel<T>();
+  return kernel;
+}
+
+// Packs an mc x kc block of A into kRows-row panels, each stored column by
+// column; rows past mc are zero-padded.
+template <class T>
+void packA(size_t mc, size_t kc, const T* a, size_t lda, T* out) {
+  constexpr size_t kRows = Tile<T>::kRows;
+  for (size_t i = 0; i < mc; i += kRows) {
+    const size_t rows = std::min(kRows, mc - i);
+    for (size_t p = 0; p < kc; ++p) {
+      for (size_t r = 0; r < rows; ++r) {
+        out[r] = a[(i + r) * lda + p];
+      }
+      for (size_t r = rows; r < kRows; ++r) {
+        out[r] = T();
+      }
+      out += kRows;
+    }
+  }
+}
+
+// Packs a kc x nc block of B into kCols-column panels, each stored row by
+// row; columns past nc are zero-padded.
+template <class T>
+void packB(size_t kc, size_t nc, const T* b, size_t ldb, T* out) {
+  constexpr size_t kCols = Tile<T>::kCols;
+  for (size_t j = 0; j < nc; j += kCols) {
+    const size_t cols = std::min(kCols, nc - j);
+    for (size_t p = 0; p < kc; ++p) {
+      const T* row = b + p * ldb + j;
+      for (size_t q = 0; q < cols; ++q) {
+        out[q] = row[q];
+      }
+      for (size_t q = cols; q < kCols; ++q) {
+        out[q] = T();
+      }
+      out += kCols;
+    }
+  }
+}
+
+// Runs the micro-kernel over every register tile of an mc x nc block.
+// Full tiles accumulate straight into C, ragged edge tiles go through a
+// small local tile first.
+template <class T>
+void macroKernel(size_t mc, size_t nc, size_t kc,
+                 const T* packed_a, const T* packed_b,
+                 T* c, size_t ldc) {
+  constexpr size_t kRows = Tile<T>::kRows;
+  constexpr size_t kCols = Tile<T>::kCols;
+  const MicroKernel<T> kernel = microKernel<T>();
+  for (size_t j = 0; j < nc; j += kCols) {
+    const size_t cols = std::min(kCols, nc - j);
+    const T* panel_b = packed_b + j * kc;
+    for (size_t i = 0; i < mc; i += kRows) {
+      const size_t rows = std::min(kRows, mc - i);
+      const T* panel_a = packed_a + i * kc;
+      T* tile = c + i * ldc + j;
+      if (rows == kRows && cols == kCols) {
+        kernel(kc, panel_a, panel_b, tile, ldc);
+        continue;
+      }
+      alignas(kBufferAlignment) T edge[kRows * kCols] = {};
+      kernel(kc, panel_a, panel_b, edge, kCols);
+      for (size_t r = 0; r < rows; ++r) {
+        for (size_t q = 0; q < cols; ++q) {
+          tile[r * ldc + q] += edge[r * kCols + q];
+        }
+      }
+    }
+  }
+}
+
+// out(i, j) = value(i, j) over an n x n block; the Strassen recursion
+// builds its operand sums and folds products into C with it, one pass
+// over memory per block.
+template <class T, class Value>
+void assign(size_t n, T* out, size_t ldo, Value value) {
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      out[i * ldo + j] = value(i, j);
+    }
+  }
+}
+
+template <class T>
+struct IsModular : std::false_type {};
+
+template <uint32_t Mod>
+struct IsModular<Modular<Mod>> : std::true_type {};
+
+// sum[j] += factor * row[j] for j < n; the inner loop of modularProduct.
+using ModularRowKernel = void (*)(size_t n, uint32_t factor, const uint32_t* row, uint64_t* sum);
+
+void scalarModularRow(size_t n, uint32_t factor, const uint32_t* row, uint64_t* sum) {
+  for (size_t j = 0; j < n; ++j) {
+    sum[j] += uint64_t(factor) * row[j];
+  }
+}
+
+#ifdef TASK_GEMM_X86
+
+__attribute__((target("avx2")))
+void avx2ModularRow(size_t n, uint32_t factor, const uint32_t* row, uint64_t* sum) {
+  const __m256i broadcast = _mm256_set1_epi64x(factor);
+  size_t j = 0;
+  for (; j + 4 <= n; j += 4) {
+    const __m256i values = _mm256_cvtepu32_epi64(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j)));
+    __m256i* out = reinterpret_cast<__m256i*>(sum + j);
+    _mm256_storeu_si256(out, _mm256_add_epi64(_mm256_loadu_si256(out),
+                                              _mm256_mul_epu32(broadcast, values)));
+  }
+  scalarModularRow(n - j, factor, row + j, sum + j);
+}
+
+#endif  // TASK_GEMM_X86
+
+ModularRowKernel modularRowKernel() {
+#ifdef TASK_GEMM_X86
+  static const ModularRowKernel kernel = hasAvx2Fma() ? avx2ModularRow : scalarModularRow;
+#else
+  static const ModularRowKernel kernel = scalarModularRow;
+#endif
+  return kernel;
+}
+
+// i-k-j product for Modular elements that sums raw 64-bit products of the
+// reduced values and reduces only every kLazy steps, as often as the sum
+// could overflow, instead of after every multiply-add.
+template <uint32_t Mod>
+void modularProduct(size_t m, size_t n, size_t k,
+                    const Modular<Mod>* a, size_t lda,
+                    const Modular<Mod>* b, size_t ldb,
+                    Modular<Mod>* c, size_t ldc) {
+  constexpr uint64_t kLargest = uint64_t(Mod - 1) * (Mod - 1);
+  constexpr size_t kLazy = (UINT64_MAX - (Mod - 1)) / kLargest;
+  const size_t grain = std::max<size_t>(1, parallel::kGrain / std::max<size_t>(n * k, 1));
+  parallel::forRange(m, grain, [&](size_t begin, size_t end) {
+    // A local copy: `n` is a size_t like the sums, so the compiler could
+    // not otherwise tell that the stores below leave it unchanged.
+    const size_t cols = n;
+    const ModularRowKernel kernel = modularRowKernel();
+    thread_local PackBuffer<uint64_t> buffer;
+    uint64_t* sum = buffer.reserve(cols);
+    for (size_t i = begin; i < end; ++i) {
+      Modular<Mod>* out = c + i * ldc;
+      for (size_t j = 0; j < cols; ++j) {
+        sum[j] = out[j].value();
+      }
+      for (size_t p = 0; p < k; ++p) {
+        if (p % kLazy == 0 && p > 0) {
+          for (size_t j = 0; j < cols; ++j) {
+            sum[j] %= Mod;
+          }
+        }
+        // Modular is standard layout around its one uint32_t, so rows can
+        // be read as plain integers.
+        kernel(cols, a[i * lda + p].value(), reinterpret_cast<const uint32_t*>(b + p * ldb), sum);
+      }
+      for (size_t j = 0; j < cols; ++j) {
+        out[j] = Modular<Mod>(static_cast<int64_t>(sum[j] % Mod));
+      }
+    }
+  });
+}
+
+// gemm::multiply without the Strassen branch, for the leaves and fix-ups
+// of the recursion: re-entering strassen() would reuse the arena that the
+// running call is still working in.
+template <class T>
+void classic(size_t m, size_t n, size_t k, const T* a, size_t lda,
+             const T* b, size_t ldb, T* c, size_t ldc) {
+  if constexpr (IsModular<T>::value) {
+    modularProduct(m, n, k, a, lda, b, ldb, c, ldc);
+  } else if (m * n * k < kBlockedThreshold) {
+    simple(m, n, k, a, lda, b, ldb, c, ldc);
+  } else {
+    blocked(m, n, k, a, lda, b, ldb, c, ldc);
+  }
+}
+
+// Arena elements the recursion below needs for order n: three h x h
+// temporaries per level, reused by the sibling calls of the next one.
+size_t strassenScratch(size_t n, size_t cutoff) {
+  size_t total = 0;
+  while (n >= cutoff && n > 1) {
+    n -= n % 2;
+    n /= 2;
+    total += 3 * n * n;
+  }
+  return total;
+}
+
+// C += A * B with the three level temporaries X, Y (operand combinations)
+// and W (a product shared by several blocks of C) at the front of
+// `scratch`. With h = n / 2 and Winograd's sums
+//   S1 = A21 + A22, S2 = S1 - A11, S3 = A11 - A21, S4 = A12 - S2,
+//   T1 = B12 - B11, T2 = B22 - T1,  T3 = B22 - B12, T4 = T2 - B21,
+// the seven products P1 = A11 B11, P2 = A12 B21, P3 = S4 B22, P4 = A22 T4,
+// P5 = S1 T1, P6 = S2 T2, P7 = S3 T3 combine into
+//   C11 = P1 + P2,            C12 = P1 + P6 + P5 + P3,
+//   C21 = P1 + P6 + P7 - P4,  C22 = P1 + P6 + P7 + P5.
+// The products with a single use accumulate straight into C.
+template <class T>
+void strassenStep(size_t n, const T* a, size_t lda, const T* b, size_t ldb,
+                  T* c, size_t ldc, size_t cutoff, T* scratch) {
+  if (n < cutoff || n < 2) {
+    classic(n, n, n, a, lda, b, ldb, c, ldc);
+    return;
+  }
+  if (n % 2 != 0) {
+    // Recurse on the leading even part; the last column of A times the last
+    // row of B touches all of C, the rest only its last row and column.
+    const size_t e = n - 1;
+    strassenStep(e, a, lda, b, ldb, c, ldc, cutoff, scratch);
+    classic(n, n, 1, a + e, lda, b + e * ldb, ldb, c, ldc);
+    classic(e, 1, e, a, lda, b + e, ldb, c + e, ldc);
+    classic(1, n, e, a + e * lda, lda, b, ldb, c + e * ldc, ldc);
+    return;
+  }
+
+  const size_t h = n / 2;
+  const T* a11 = a;
+  const T* a12 = a + h;
+  const T* a21 = a + h * lda;
+  const T* a22 = a21 + h;
+  const T* b11 = b;
+  const T* b12 = b + h;
+  const T* b21 = b + h * ldb;
+  const T* b22 = b21 + h;
+  T* c11 = c;
+  T* c12 = c + h;
+  T* c21 = c + h * ldc;
+  T* c22 = c21 + h;
+  T* x = scratch;
+  T* y = x + h * h;
+  T* w = y + h * h;
+  T* next = w + h * h;
+
+  // Element (i, j) of a block starting at `p` with leading dimension `ld`.
+  const auto at = [](const T* p, size_t ld) {
+    return [p, ld](size_t i, size_t j) { return p[i * ld + j]; };
+  };
+  const auto A11 = at(a11, lda), A12 = at(a12, lda), A21 = at(a21, lda), A22 = at(a22, lda);
+  const auto B11 = at(b11, ldb), B12 = at(b12, ldb), B21 = at(b21, ldb), B22 = at(b22, ldb);
+  const auto X = at(x, h), W = at(w, h);
+
+  // W = P1; C11 += P1 + P2.
+  std::fill_n(w, h * h, T());
+  strassenStep(h, a11, lda, b11, ldb, w, h, cutoff, next);
+  assign(h, c11, ldc, [&](size_t i, size_t j) { return c11[i * ldc + j] + W(i, j); });
+  strassenStep(h, a12, lda, b21, ldb, c11, ldc, cutoff, next);
+
+  // W = P1 + P6; C12 += W.
+  assign(h, x, h, [&](size_t i, size_t j) { return A21(i, j) + A22(i, j) - A11(i, j); });
+  assign(h, y, h, [&](size_t i, size_t j) { return B22(i, j) - B12(i, j) + B11(i, j); });
+  strassenStep(h, x, h, y, h, w, h, cutoff, next);
+  assign(h, c12, ldc, [&](size_t i, size_t j) { return c12[i * ldc + j] + W(i, j); });
+
+  // W = P1 + P6 + P7; C21 += W, C22 += W.
+  assign(h, x, h, [&](size_t i, size_t j) { return A11(i, j) - A21(i, j); });
+  assign(h, y, h, [&](size_t i, size_t j) { return B22(i, j) - B12(i, j); });
+  strassenStep(h, x, h, y, h, w, h, cutoff, next);
+  assign(h, c21, ldc, [&](size_t i, size_t j) { return c21[i * ldc + j] + W(i, j); });
+  assign(h, c22, ldc, [&](size_t i, size_t j) { return c22[i * ldc + j] + W(i, j); });
+
+  // W = P5; C12 += W, C22 += W.
+  assign(h, x, h, [&](size_t i, size_t j) { return A21(i, j) + A22(i, j); });
+  assign(h, y, h, [&](size_t i, size_t j) { return B12(i, j) - B11(i, j); });
+  std::fill_n(w, h * h, T());
+  strassenStep(h, x, h, y, h, w, h, cutoff, next);
+  assign(h, c12, ldc, [&](size_t i, size_t j) { return c12[i * ldc + j] + W(i, j); });
+  assign(h, c22, ldc, [&](size_t i, size_t j) { return c22[i * ldc + j] + W(i, j); });
+
+  // C12 += S4 B22, with S4 = A12 - S1 + A11.
+  assign(h, x, h, [&](size_t i, size_t j) { return A12(i, j) - X(i, j) + A11(i, j); });
+  strassenStep(h, x, h, b22, ldb, c12, ldc, cutoff, next);
+
+  // C21 -= P4, as C21 += A22 (-T4) with -T4 = B21 - B22 + B12 - B11.
+  assign(h, y, h, [&](size_t i, size_t j) {
+    return B21(i, j) - B22(i, j) + B12(i, j) - B11(i, j);
+  });
+  strassenStep(h, a22, lda, y, h, c21, ldc, cutoff, next);
+}
+
+}  // namespace
+
+template <class T>
+void multiply(size_t m, size_t n, size_t k,
+              const T* a, size_t lda,
+              const T* b, size_t ldb,
+              T* c, size_t ldc) {
+  if (m == n && n == k && n >= kStrassenCutoff) {
+    strassen(n, a, lda, b, ldb, c, ldc);
+  } else {
+    classic(m, n, k, a, lda, b, ldb, c, ldc);
+  }
+}
+
+template <class T>
+void blocked(size_t m, size_t n, size_t k,
+             const T* a, size_t lda,
+             const T* b, size_t ldb,
+             T* c, size_t ldc) {
+  constexpr size_t kRows = Tile<T>::kRows;
+  constexpr size_t kCols = Tile<T>::kCols;
+  thread_local PackBuffer<T> buffer_a;
+  thread_local PackBuffer<T> buffer_b;
+  const size_t m_padded = (m + kRows - 1) / kRows * kRows;
+  const size_t nc_max = (std::min(kNC, n) + kCols - 1) / kCols * kCols;
+  T* packed_a = buffer_a.reserve(m_padded * kKC);
+  T* packed_b = buffer_b.reserve(nc_max * kKC);
+  const size_t row_blocks = (m + kMC - 1) / kMC;
+
+  for (size_t jc = 0; jc < n; jc += kNC) {
+    const size_t nc = std::min(kNC, n - jc);
+    const size_t column_groups = (nc + kNG<T> - 1) / kNG<T>;
+    for (size_t pc = 0; pc < k; pc += kKC) {
+      const size_t kc = std::min(kKC, k - pc);
+
+      // Both operands are packed once per (jc, pc) step and then shared
+      // read-only by every block of C.
+      const size_t panels = (nc + kCols - 1) / kCols;
+      parallel::forRange(panels, kPackGrain, [&](size_t begin, size_t end) {
+        const size_t first = begin * kCols;
+        packB(kc, std::min(end * kCols, nc) - first, b + pc * ldb + jc + first,
+              ldb, packed_b + first * kc);
+      });
+      parallel::forRange(row_blocks, 1, [&](size_t begin, size_t end) {
+        const size_t first = begin * kMC;
+        packA(std::min(end * kMC, m) - first, kc, a + first * lda + pc, lda,
+              packed_a + first * kc);
+      });
+
+      // Each task owns a disjoint mc x kNG block of C, so the order of the
+      // additions into every element does not depend on the thread count.
+      parallel::forRange(row_blocks * column_groups, 1,
+                         [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+          const size_t ic = t / column_groups * kMC;
+          const size_t jg = t % column_groups * kNG<T>;
+          macroKernel(std::min(kMC, m - ic), std::min(kNG<T>, nc - jg), kc,
+                      packed_a + ic * kc, packed_b + jg * kc,
+                      c + ic * ldc + jc + jg, ldc);
+        }
+      });
+    }
+  }
+}
+
+template <class T>
+void strassen(size_t n,
+              const T* a, size_t lda,
+              const T* b, size_t ldb,
+              T* c, size_t ldc,
+              size_t cutoff) {
+  thread_local PackBuffer<T> arena;
+  T* scratch = arena.reserve(strassenScratch(n, cutoff));
+  strassenStep(n, a, lda, b, ldb, c, ldc, cutoff, scratch);
+}
+
+template <class T>
+void simple(size_t m, size_t n, size_t k,
+            const T* a, size_t lda,
+            const T* b, size_t ldb,
+            T* c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i) {
+    T* out = c + i * ldc;
+    for (size_t p = 0; p < k; ++p) {
+      const T factor = a[i * lda + p];
+      const T* row = b + p * ldb;
+      for (size_t j = 0; j < n; ++j) {
+        out[j] += factor * row[j];
+      }
+    }
+  }
+}
+
+template <class T>
+void reference(size_t m, size_t n, size_t k,
+               const T* a, size_t lda,
+               const T* b, size_t ldb,
+               T* c, size_t ldc) {
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      T sum = T();
+      for (size_t p = 0; p < k; ++p) {
+        sum += a[i * lda + p] * b[p * ldb + j];
+      }
+      c[i * ldc + j] += sum;
+    }
+  }
+}
+
+template <class T>
+const char* kernelName() {
+  return microKernel<T>() == scalarKernel<T> ? "scalar" : "avx2-fma";
+}
+
+#define TASK_INSTANTIATE_GEMM(T)                                                  \
+  template void multiply(size_t, size_t, size_t, const T*, size_t, const T*,      \
+                         size_t, T*, size_t);                                     \
+  template void blocked(size_t, size_t, size_t, const T*, size_t, const T*,       \
+                        size_t, T*, size_t);                                      \
+  template void strassen(size_t, const T*, size_t, const T*, size_t, T*, size_t,  \
+                         size_t);                                                 \
+  template void simple(size_t, size_t, size_t, const T*, size_t, const T*,        \
+                       size_t, T*, size_t);                                       \
+  template void reference(size_t, size_t, size_t, const T*, size_t, const T*,     \
+                          size_t, T*, size_t);                                    \
+  template const char* kernelName<T>();
+
+TASK_INSTANTIATE_GEMM(double)
+TASK_INSTANTIATE_GEMM(float)
+TASK_INSTANTIATE_GEMM(int64_t)
+TASK_INSTANTIATE_GEMM(std::complex<double>)
+TASK_INSTANTIATE_GEMM(ModInt)
+
+}  // namespace gemm
+}  // namespace task
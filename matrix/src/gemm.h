@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+
+
+namespace task {
+namespace gemm {
+
+// Products with fewer multiply-adds than this go through the simple row
+// kernel; packing the operands does not pay off below it.
+const size_t kBlockedThreshold = 32 * 32 * 32;
+
+// Blocking parameters of the packed kernel: an MR x NR register tile,
+// KC-deep panels that stay in L1, MC x KC blocks of A that stay in L2 and
+// KC x NC blocks of B that stay in L3. The register tile is the one for
+// double; float tiles are twice as wide, since a vector holds twice as many
+// floats.
+const size_t kMR = 4;
+const size_t kNR = 8;
+const size_t kKC = 256;
+const size_t kMC = 96;
+const size_t kNC = 2048;
+
+// Square products of at least this order go through Strassen-Winograd,
+// whose recursion stops below the same order. See strassen_bench for the
+// crossover on a given host.
+const size_t kStrassenCutoff = 2048;
+
+// C[m x n] += A[m x k] * B[k x n]; all operands are row-major with the
+// given leading dimensions. Chooses the kernel by problem size.
+template <class T>
+void multiply(size_t m, size_t n, size_t k,
+              const T* a, size_t lda,
+              const T* b, size_t ldb,
+              T* c, size_t ldc);
+
+// Packed, cache-blocked product; uses an AVX2/FMA micro-kernel for double
+// and float when the CPU supports it and a portable scalar one otherwise.
+template <class T>
+void blocked(size_t m, size_t n, size_t k,
+             const T* a, size_t lda,
+             const T* b, size_t ldb,
+             T* c, size_t ldc);
+
+// Square C[n x n] += A * B by Winograd's form of Strassen's recursion:
+// seven half-size products per level instead of eight, with the blocked
+// kernel below `cutoff`. An odd order peels off the last row and column
+// and fixes them up with thin products. Temporaries come from one
+// per-thread arena sized up front, so the recursion does not allocate.
+// Rounding error grows by a small factor per level compared to blocked().
+template <class T>
+void strassen(size_t n,
+              const T* a, size_t lda,
+              const T* b, size_t ldb,
+              T* c, size_t ldc,
+              size_t cutoff = kStrassenCutoff);
+
+// Unblocked i-k-j loop; the best choice for small operands.
+template <class T>
+void simple(size_t m, size_t n, size_t k,
+            const T* a, size_t lda,
+            const T* b, size_t ldb,
+            T* c, size_t ldc);
+
+// Textbook i-j-k loop, kept as the baseline for tests and benchmarks.
+template <class T>
+void reference(size_t m, size_t n, size_t k,
+               const T* a, size_t lda,
+               const T* b, size_t ldb,
+               T* c, size_t ldc);
+
+// Name of the micro-kernel picked for T on this CPU ("avx2-fma" or
+// "scalar").
+template <class T = double>
+const char* kernelName();
+
+// All of the above are instantiated for the element types of the Matrix
+// aliases in matrix.h.
+
+}  // namespace gemm
+}  // namespace task
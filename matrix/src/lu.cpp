@@ -0,0 +1,209 @@
+#include "lu.h"
+#include "gemm.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace task;
+
+LU::LU(const Matrix& matrix)
+    : lu_(matrix), n_(matrix.getRows()), sign_(1), singular_(false) {
+  if (matrix.getRows() != matrix.getCols()) {
+    throw SizeMismatchException();
+  }
+  factorize();
+}
+
+// Right-looking blocked elimination: factorize a panel of kPanel columns,
+// solve for the matching rows of U to its right, then update the trailing
+// submatrix with a single gemm call straight into lu_.
+void LU::factorize() {
+  pivots_.resize(n_);
+  for (size_t i = 0; i < n_; ++i) {
+    pivots_[i] = i;
+  }
+  // -U12 of the current panel, so gemm's C += A * B does the subtraction.
+  std::vector<double> negated(kPanel * n_);
+
+  for (size_t k = 0; k < n_ && !singular_; k += kPanel) {
+    const size_t width = std::min(kPanel, n_ - k);
+    factorizePanel(k, width);
+    const size_t rest = n_ - k - width;
+    if (singular_ || rest == 0) {
+      continue;
+    }
+
+    // U12 = L11^-1 * A12, row by row with the unit lower triangle of the panel.
+    MatrixView u12 = lu_.block(k, k + width, width, rest);
+    const ConstMatrixView l11 = lu_.block(k, k, width, width);
+    for (size_t i = 1; i < width; ++i) {
+      double* out = &u12[i][0];
+      for (size_t p = 0; p < i; ++p) {
+        const double factor = l11[i][p];
+        const double* solved = &u12[p][0];
+        for (size_t j = 0; j < rest; ++j) {
+          out[j] -= factor * solved[j];
+        }
+      }
+    }
+
+    // A22 -= L21 * U12.
+    for (size_t i = 0; i < width; ++i) {
+      const double* source = &u12[i][0];
+      double* out = negated.data() + i * rest;
+      for (size_t j = 0; j < rest; ++j) {
+        out[j] = -source[j];
+      }
+    }
+    const size_t stride = lu_.getStride();
+    double* a22 = lu_.data() + (k + width) * stride + k + width;
+    const double* l21 = lu_.data() + (k + width) * stride + k;
+    gemm::multiply(rest, rest, width, l21, stride, negated.data(), rest, a22, stride);
+  }
+}
+
+// Unblocked elimination of columns [k, k + width), rows k and below. Row
+// swaps span the whole matrix; updates stay inside the panel.
+void LU::factorizePanel(size_t k, size_t width) {
+  double* data = lu_.data();
+  const size_t stride = lu_.getStride();
+  for (size_t c = k; c < k + width; ++c) {
+    size_t pivot = c;
+    double best = std::fabs(data[c * stride + c]);
+    for (size_t i = c + 1; i < n_; ++i) {
+      const double candidate = std::fabs(data[i * stride + c]);
+      if (candidate > best) {
+        best = candidate;
+        pivot = i;
+      }
+    }
+    if (best == 0.0) {
+      // Nothing left to compute: det() is 0 and solving throws.
+      singular_ = true;
+      return;
+    }
+    if (pivot != c) {
+      std::swap_ranges(data + c * stride, data + c * stride + n_,
+                       data + pivot * stride);
+      std::swap(pivots_[c], pivots_[pivot]);
+      sign_ = -sign_;
+    }
+
+    // Every row below the pivot is updated independently of the others.
+    const double* pivot_row = data + c * stride;
+    const double inv_pivot = 1.0 / pivot_row[c];
+    const size_t end_col = k + width;
+    const size_t grain = std::max<size_t>(1, parallel::kGrain / (end_col - c));
+    parallel::forRange(n_ - c - 1, grain, [&](size_t begin, size_t end) {
+      for (size_t i = c + 1 + begin; i < c + 1 + end; ++i) {
+        double* row = data + i * stride;
+        const double factor = row[c] * inv_pivot;
+        row[c] = factor;
+        for (size_t j = c + 1; j < end_col; ++j) {
+          row[j] -= factor * pivot_row[j];
+        }
+      }
+    });
+  }
+}
+
+double LU::det() const {
+  if (singular_) {
+    return 0.0;
+  }
+  const double* data = lu_.data();
+  const size_t stride = lu_.getStride();
+  double result = sign_;
+  for (size_t i = 0; i < n_; ++i) {
+    result *= data[i * stride + i];
+  }
+  return result;
+}
+
+bool LU::isSingular() const {
+  return singular_;
+}
+
+// Overwrites the already permuted right-hand sides in x (n_ rows of `cols`
+// values, `ldx` apart) with the solution: forward substitution with the
+// unit L, then back substitution with U. Works a whole row of x at a time.
+void LU::substitute(double* x, size_t ldx, size_t cols) const {
+  if (singular_) {
+    throw SingularMatrixException();
+  }
+  const double* data = lu_.data();
+  const size_t stride = lu_.getStride();
+
+  for (size_t i = 1; i < n_; ++i) {
+    const double* lower = data + i * stride;
+    double* out = x + i * ldx;
+    for (size_t k = 0; k < i; ++k) {
+      const double factor = lower[k];
+      const double* solved = x + k * ldx;
+      for (size_t j = 0; j < cols; ++j) {
+        out[j] -= factor * solved[j];
+      }
+    }
+  }
+
+  for (size_t i = n_; i-- > 0;) {
+    const double* upper = data + i * stride;
+    double* out = x + i * ldx;
+    for (size_t k = i + 1; k < n_; ++k) {
+      const double factor = upper[k];
+      const double* solved = x + k * ldx;
+      for (size_t j = 0; j < cols; ++j) {
+        out[j] -= factor * solved[j];
+      }
+    }
+    const double inv_diagonal = 1.0 / upper[i];
+    for (size_t j = 0; j < cols; ++j) {
+      out[j] *= inv_diagonal;
+    }
+  }
+}
+
+Matrix LU::solve(const Matrix& b) const {
+  if (b.getRows() != n_) {
+    throw SizeMismatchException();
+  }
+  const size_t cols = b.getCols();
+  Matrix x(n_, cols);
+  for (size_t i = 0; i < n_; ++i) {
+    std::memcpy(x.data() + i * x.getStride(),
+                b.data() + pivots_[i] * b.getStride(), cols * sizeof(double));
+  }
+  substitute(x.data(), x.getStride(), cols);
+  return x;
+}
+
+std::vector<double> LU::solve(const std::vector<double>& b) const {
+  if (b.size() != n_) {
+    throw SizeMismatchException();
+  }
+  std::vector<double> x(n_);
+  for (size_t i = 0; i < n_; ++i) {
+    x[i] = b[pivots_[i]];
+  }
+  substitute(x.data(), 1, 1);
+  return x;
+}
+
+Matrix LU::inverse() const {
+  return solve(Matrix(n_, n_));
+}
+
+size_t LU::size() const {
+  return n_;
+}
+
+const Matrix& LU::factors() const {
+  return lu_;
+}
+
+const std::vector<size_t>& LU::pivots() const {
+  return pivots_;
+}
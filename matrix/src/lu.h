@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// LU factorization with partial pivoting, P * A = L * U. Factorizing costs
+// O(n^3) once; every solve() afterwards is O(n^2) per right-hand side.
+class LU {
+
+public:
+
+    explicit LU(const Matrix& matrix);
+
+    double det() const;
+    bool isSingular() const;
+
+    Matrix solve(const Matrix& b) const;
+    std::vector<double> solve(const std::vector<double>& b) const;
+    Matrix inverse() const;
+
+    size_t size() const;
+
+    // Unit lower triangle (implicit ones on the diagonal) and U packed
+    // into one matrix, in pivoted row order. Factorization stops at the
+    // first zero pivot, so for a singular matrix they are incomplete.
+    const Matrix& factors() const;
+    // pivots()[i] is the row of A that ended up as row i.
+    const std::vector<size_t>& pivots() const;
+
+ private:
+
+    // Columns per panel of the blocked factorization.
+    static constexpr size_t kPanel = 64;
+
+    void factorize();
+    void factorizePanel(size_t k, size_t width);
+    void substitute(double* x, size_t ldx, size_t cols) const;
+
+    Matrix lu_;
+    std::vector<size_t> pivots_;
+    size_t n_;
+    int sign_;
+    bool singular_;
+
+};
+
+}  // namespace task
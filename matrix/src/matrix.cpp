@@ -1,247 +1,509 @@
 #include "matrix.h"
+#include "gemm.h"
+#include "lu.h"
+#include "pool.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
 using namespace task;
 
-Matrix::Matrix::Matrix() :  rows_(1), cols_(1) {
+namespace {
+
+// Gaussian elimination on a copy of the matrix: partial pivoting for
+// floating point types, the first nonzero pivot for exact fields.
+template <class T>
+T eliminationDet(BasicMatrix<T> a) {
+  const size_t n = a.getRows();
+  const size_t stride = a.getStride();
+  T* data = a.data();
+  T result = T(1);
+  for (size_t k = 0; k < n; ++k) {
+    size_t pivot = k;
+    for (size_t i = k + 1; i < n; ++i) {
+      if constexpr (ElementTraits<T>::kExact) {
+        if (data[pivot * stride + k] != T()) {
+          break;
+        }
+        pivot = i;
+      } else if (std::abs(data[i * stride + k]) > std::abs(data[pivot * stride + k])) {
+        pivot = i;
+      }
+    }
+    if (data[pivot * stride + k] == T()) {
+      return T();
+    }
+    if (pivot != k) {
+      std::swap_ranges(data + k * stride, data + k * stride + n, data + pivot * stride);
+      result = -result;
+    }
+    const T* pivot_row = data + k * stride;
+    result *= pivot_row[k];
+    for (size_t i = k + 1; i < n; ++i) {
+      T* row = data + i * stride;
+      const T factor = row[k] / pivot_row[k];
+      for (size_t j = k + 1; j < n; ++j) {
+        row[j] -= factor * pivot_row[j];
+      }
+    }
+  }
+  return result;
+}
+
+// Bareiss fraction-free elimination: every division is exact, so integral
+// types get the exact determinant.
+template <class T>
+T bareissDet(BasicMatrix<T> a) {
+  const size_t n = a.getRows();
+  if (n == 0) {
+    return T(1);
+  }
+  const size_t stride = a.getStride();
+  T* data = a.data();
+  T sign = T(1);
+  T previous = T(1);
+  for (size_t k = 0; k + 1 < n; ++k) {
+    if (data[k * stride + k] == T()) {
+      size_t pivot = k + 1;
+      while (pivot < n && data[pivot * stride + k] == T()) {
+        ++pivot;
+      }
+      if (pivot == n) {
+        return T();
+      }
+      std::swap_ranges(data + k * stride, data + k * stride + n, data + pivot * stride);
+      sign = -sign;
+    }
+    const T* pivot_row = data + k * stride;
+    for (size_t i = k + 1; i < n; ++i) {
+      T* row = data + i * stride;
+      for (size_t j = k + 1; j < n; ++j) {
+        row[j] = (row[j] * pivot_row[k] - row[k] * pivot_row[j]) / previous;
+      }
+    }
+    previous = pivot_row[k];
+  }
+  return sign * data[(n - 1) * stride + n - 1];
+}
+
+// Products pow(k) computes: a squaring per bit below the highest one and
+// a multiplication per set bit after the first.
+[[maybe_unused]] uint64_t powerProducts(uint64_t k) {
+  uint64_t products = 0;
+  for (bool first = true; k > 0; k >>= 1) {
+    if (k & 1) {
+      products += first ? 0 : 1;
+      first = false;
+    }
+    products += k > 1 ? 1 : 0;
+  }
+  return products;
+}
+
+}  // namespace
+
+template <class T>
+BasicMatrix<T>::BasicMatrix() : rows_(1), cols_(1), stride_(strideFor(1)) {
   allocSpace();
-  data_[0][0] = 1.0;
+  data_[0] = T(1);
 }
 
-Matrix::Matrix(size_t rows, size_t cols) : rows_(rows), cols_(cols) {
+template <class T>
+BasicMatrix<T>::BasicMatrix(size_t rows, size_t cols)
+    : rows_(rows), cols_(cols), stride_(strideFor(cols)) {
   allocSpace();
-  data_[0][0] = 1.0;
   for (size_t i = 0; i < std::min(cols, rows); ++i) {
-    data_[i][i] = 1.0;
+    rowData(i)[i] = T(1);
   }
 }
 
-Matrix::Matrix(const Matrix& copy) : rows_(copy.rows_), cols_(copy.cols_) {
-  allocSpace();
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      data_[i][j] = copy.data_[i][j];
-    }
+template <class T>
+BasicMatrix<T>::BasicMatrix(const BasicMatrix& copy)
+    : rows_(copy.rows_), cols_(copy.cols_), stride_(copy.stride_) {
+  data_ = allocate(rows_ * stride_);
+  if (rows_ * stride_ != 0) {
+    std::memcpy(data_, copy.data_, rows_ * stride_ * sizeof(T));
   }
 }
 
-Matrix::~Matrix() {
-  for (int i = 0; i < rows_; ++i) {
-    delete[] data_[i];
-  }
-  delete[] data_;
+template <class T>
+BasicMatrix<T>::BasicMatrix(BasicMatrix&& other) noexcept
+    : data_(other.data_), rows_(other.rows_), cols_(other.cols_),
+      stride_(other.stride_), mapping_(other.mapping_),
+      mapping_size_(other.mapping_size_) {
+  other.data_ = nullptr;
+  other.rows_ = other.cols_ = other.stride_ = 0;
+  other.mapping_ = nullptr;
+  other.mapping_size_ = 0;
 }
 
-Matrix& Matrix::operator=(const Matrix& a) {
+template <class T>
+BasicMatrix<T>::~BasicMatrix() {
+  freeSpace();
+}
+
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const BasicMatrix& a) {
   if (&a == this) {
     return *this;
   }
-  if (rows_ != a.rows_ || cols_ != a.cols_) {
-    for (int i = 0; i < rows_; ++i) {
-      delete[] data_[i];
-    }
-    delete[] data_;
-
-    rows_ = a.rows_;
-    cols_ = a.cols_;
-    allocSpace();
+  if (rows_ * stride_ != a.rows_ * a.stride_) {
+    freeSpace();
+    data_ = allocate(a.rows_ * a.stride_);
   }
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      data_[i][j] = a.data_[i][j];
-    }
+  rows_ = a.rows_;
+  cols_ = a.cols_;
+  stride_ = a.stride_;
+  if (rows_ * stride_ != 0) {
+    std::memcpy(data_, a.data_, rows_ * stride_ * sizeof(T));
+  }
+  return *this;
+}
+
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator=(BasicMatrix&& other) noexcept {
+  if (&other == this) {
+    return *this;
   }
+  freeSpace();
+  data_ = other.data_;
+  rows_ = other.rows_;
+  cols_ = other.cols_;
+  stride_ = other.stride_;
+  mapping_ = other.mapping_;
+  mapping_size_ = other.mapping_size_;
+  other.data_ = nullptr;
+  other.rows_ = other.cols_ = other.stride_ = 0;
+  other.mapping_ = nullptr;
+  other.mapping_size_ = 0;
   return *this;
 }
 
-double& Matrix::get(size_t row, size_t col) {
+template <class T>
+T& BasicMatrix<T>::get(size_t row, size_t col) {
   checkBounds(row, col);
-  return data_[row][col];
+  return rowData(row)[col];
 }
 
-const double& Matrix::get(size_t row, size_t col) const {
+template <class T>
+const T& BasicMatrix<T>::get(size_t row, size_t col) const {
   checkBounds(row, col);
-  return data_[row][col];
+  return rowData(row)[col];
 }
 
-void Matrix::set(size_t row, size_t col, const double& value) {
+template <class T>
+void BasicMatrix<T>::set(size_t row, size_t col, const T& value) {
   checkBounds(row, col);
-  data_[row][col] = value;
+  rowData(row)[col] = value;
 }
 
-void Matrix::resize(size_t new_rows, size_t new_cols) {
+template <class T>
+void BasicMatrix<T>::resize(size_t new_rows, size_t new_cols) {
+  TASK_PROFILE_SCOPE(kResize, 0);
   if (new_rows < 1 || new_cols < 1) {
     throw OutOfBoundsException();
   }
-  double** new_data = new double*[new_rows];
-  for (size_t i = 0; i < new_rows; ++i) {
-    new_data[i] = new double[new_cols];
+  if (new_rows == rows_ && new_cols == cols_) {
+    return;
   }
+  size_t new_stride = strideFor(new_cols);
+  T* new_data = allocate(new_rows * new_stride);
   size_t row_size = std::min(rows_, new_rows);
-  size_t col_size = std::min(cols_, new_cols);
-  for (size_t i = 0; i < row_size; ++i) {
-    for (size_t j = 0; j < col_size; ++j) {
-      new_data[i][j] = data_[i][j];
+  if (new_stride == stride_) {
+    std::memcpy(new_data, data_, row_size * stride_ * sizeof(T));
+    if (new_cols < cols_) {
+      for (size_t i = 0; i < row_size; ++i) {
+        std::fill_n(new_data + i * new_stride + new_cols, cols_ - new_cols, T());
+      }
+    }
+  } else {
+    size_t col_size = std::min(cols_, new_cols);
+    for (size_t i = 0; i < row_size; ++i) {
+      std::memcpy(new_data + i * new_stride, rowData(i),
+                  col_size * sizeof(T));
+      std::fill_n(new_data + i * new_stride + col_size, new_stride - col_size, T());
     }
   }
-  for (int i = 0; i < rows_; ++i) {
-    delete[] data_[i];
-  }
-  delete[] data_;
+  std::fill_n(new_data + row_size * new_stride, (new_rows - row_size) * new_stride, T());
+  freeSpace();
   data_ = new_data;
   rows_ = new_rows;
   cols_ = new_cols;
+  stride_ = new_stride;
 }
 
-double* Matrix::operator[](size_t row) {
-  checkBounds(row, 0);
-  return data_[row];
-}
-
-double* Matrix::operator[](size_t row) const {
-  checkBounds(row, 0);
-  return data_[row];
-}
-
-Matrix& Matrix::operator+=(const Matrix& a) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator+=(const BasicMatrix& a) {
   checkSize(a);
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      data_[i][j] += a[i][j];
+  TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_);
+  parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      T* row = rowData(i);
+      const T* other = a.rowData(i);
+      for (size_t j = 0; j < cols_; ++j) {
+        row[j] += other[j];
+      }
     }
-  }
+  });
   return *this;
 }
 
-Matrix& Matrix::operator-=(const Matrix& a) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator-=(const BasicMatrix& a) {
   checkSize(a);
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      data_[i][j] -= a[i][j];
+  TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_);
+  parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      T* row = rowData(i);
+      const T* other = a.rowData(i);
+      for (size_t j = 0; j < cols_; ++j) {
+        row[j] -= other[j];
+      }
     }
-  }
+  });
   return *this;
 }
 
-Matrix& Matrix::operator*=(const Matrix& a) {
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const BasicMatrix& a) {
   if (cols_ != a.rows_) {
     throw SizeMismatchException();
   }
-  *this = *this * a;
+  TASK_PROFILE_SCOPE(kProduct, 2 * uint64_t(rows_) * cols_ * a.cols_);
+  if (a.rows_ != a.cols_ || &a == this) {
+    *this = *this * a;
+    return *this;
+  }
+  // A block of rows of the product depends only on the same block of rows
+  // of *this, so the product can overwrite *this one block at a time.
+  const size_t block = std::min(gemm::kMC, rows_);
+  BasicMatrix scratch(block, cols_);
+  for (size_t i = 0; i < rows_; i += block) {
+    const size_t rows = std::min(block, rows_ - i);
+    std::fill_n(scratch.data_, rows * stride_, T());
+    gemm::multiply(rows, cols_, cols_, rowData(i), stride_, a.data_, a.stride_,
+                   scratch.data_, stride_);
+    std::memcpy(rowData(i), scratch.data_, rows * stride_ * sizeof(T));
+  }
   return *this;
 }
 
-Matrix& Matrix::operator*=(const double& number) {
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      data_[i][j] *= number;
+template <class T>
+BasicMatrix<T>& BasicMatrix<T>::operator*=(const T& number) {
+  TASK_PROFILE_SCOPE(kElementwise, uint64_t(rows_) * cols_);
+  parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      T* row = rowData(i);
+      for (size_t j = 0; j < cols_; ++j) {
+        row[j] *= number;
+      }
     }
-  }
+  });
   return *this;
 }
 
-Matrix Matrix::operator+(const Matrix& a) const {
-  checkSize(a);
-  Matrix result = *this;
-  result += a;
-  return result;
-}
-
-Matrix Matrix::operator-(const Matrix& a) const {
-  checkSize(a);
-  Matrix result = *this;
-  result -= a;
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix& a) const & {
+  if (cols_ != a.rows_) {
+    throw SizeMismatchException();
+  }
+  TASK_PROFILE_SCOPE(kProduct, 2 * uint64_t(rows_) * cols_ * a.cols_);
+  BasicMatrix result(rows_, a.cols_);
+  std::fill_n(result.data_, result.rows_ * result.stride_, T());
+  gemm::multiply(rows_, a.cols_, cols_, data_, stride_, a.data_, a.stride_,
+                 result.data_, result.stride_);
   return result;
 }
 
-Matrix Matrix::operator*(const Matrix& a) const {
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::operator*(const BasicMatrix& a) && {
   if (cols_ != a.rows_) {
     throw SizeMismatchException();
   }
-  Matrix result(rows_, a.cols_);
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < a.cols_; ++j) {
-      result[i][j] = 0.0;
-      for (size_t k = 0; k < cols_; ++k) {
-        result[i][j] += data_[i][k] * a[k][j];
-      }
-    }
+  TASK_PROFILE_SCOPE(kProduct, 2 * uint64_t(rows_) * cols_ * a.cols_);
+  if (a.rows_ != a.cols_) {
+    return static_cast<const BasicMatrix&>(*this) * a;
   }
-  return result;
+  *this *= a;
+  return std::move(*this);
 }
 
-Matrix Matrix::operator*(const double& a) const {
-  Matrix result = *this;
-  result *= a;
-  return result;
+template <class T>
+T BasicMatrix<T>::det() const {
+  if (rows_ != cols_) {
+    throw SizeMismatchException();
+  }
+  TASK_PROFILE_SCOPE(kDet, 2 * uint64_t(rows_) * rows_ * rows_ / 3);
+  if constexpr (std::is_same_v<T, double>) {
+    return LU(*this).det();
+  } else if constexpr (std::is_integral_v<T>) {
+    return bareissDet(*this);
+  } else {
+    return eliminationDet(*this);
+  }
 }
 
-Matrix Matrix::operator-() const {
-  Matrix result(rows_, cols_);
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      result[i][j] = -data_[i][j];
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::pow(uint64_t k) const {
+  if (rows_ != cols_) {
+    throw SizeMismatchException();
+  }
+  TASK_PROFILE_SCOPE(kProduct, powerProducts(k) * 2 * uint64_t(rows_) * rows_ * rows_);
+  // result *= base for every set bit of k and base *= base in between; each
+  // product goes into `scratch`, which then swaps places with its target.
+  BasicMatrix result(rows_, cols_);
+  BasicMatrix base(*this);
+  BasicMatrix scratch(rows_, cols_);
+  const auto product = [&](const BasicMatrix& a, const BasicMatrix& b) {
+    std::fill_n(scratch.data_, rows_ * stride_, T());
+    gemm::multiply(rows_, cols_, cols_, a.data_, stride_, b.data_, stride_,
+                   scratch.data_, stride_);
+  };
+  bool identity = true;
+  for (; k > 0; k >>= 1) {
+    if (k & 1) {
+      if (identity) {
+        std::memcpy(result.data_, base.data_, rows_ * stride_ * sizeof(T));
+        identity = false;
+      } else {
+        product(result, base);
+        std::swap(result, scratch);
+      }
+    }
+    if (k > 1) {
+      product(base, base);
+      std::swap(base, scratch);
     }
   }
   return result;
 }
 
-Matrix Matrix::operator+() const {
-  return *this;
-}
-
-double Matrix::det() const {
-  return det(*this);
-}
-
-void Matrix::transpose() {
-  Matrix copy = *this;
-  *this = copy.transposed();
+template <class T>
+void BasicMatrix<T>::transpose() {
+  TASK_PROFILE_SCOPE(kTranspose, 0);
+  if (rows_ != cols_) {
+    *this = transposed();
+    return;
+  }
+  // Tile row ii swaps tiles (ii, jj) and (jj, ii) for jj >= ii only, so
+  // different tile rows never touch the same element.
+  const size_t tile = kTransposeLeaf;
+  const size_t tiles = (rows_ + tile - 1) / tile;
+  parallel::forRange(tiles, 1, [&](size_t begin, size_t end) {
+    for (size_t ii = begin * tile; ii < end * tile; ii += tile) {
+      for (size_t jj = ii; jj < cols_; jj += tile) {
+        const size_t i_end = std::min(ii + tile, rows_);
+        const size_t j_end = std::min(jj + tile, cols_);
+        for (size_t i = ii; i < i_end; ++i) {
+          for (size_t j = (ii == jj ? i + 1 : jj); j < j_end; ++j) {
+            std::swap(rowData(i)[j], rowData(j)[i]);
+          }
+        }
+      }
+    }
+  });
 }
 
-Matrix Matrix::transposed() const {
-  Matrix t_matrix(cols_, rows_);
-  for (size_t i = 0; i < rows_; ++i) {
-    for (size_t j = 0; j < cols_; ++j) {
-      t_matrix[j][i] = data_[i][j];
-    }
-  }
+template <class T>
+BasicMatrix<T> BasicMatrix<T>::transposed() const {
+  TASK_PROFILE_SCOPE(kTranspose, 0);
+  BasicMatrix t_matrix(cols_, rows_);
+  parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+    transposeBlock(rowData(begin), stride_, t_matrix.data_ + begin,
+                   t_matrix.stride_, end - begin, cols_);
+  });
   return t_matrix;
 }
 
-double Matrix::trace() const {
+template <class T>
+T BasicMatrix<T>::trace() const {
   if (rows_ != cols_) {
     throw SizeMismatchException();
   }
-  double result = 0.0;
+  T result = T();
   for (size_t i = 0; i < rows_; ++i) {
-    result += data_[i][i];
+    result += rowData(i)[i];
   }
   return result;
 }
 
-std::vector<double> Matrix::getRow(size_t row) {
+template <class T>
+std::vector<T> BasicMatrix<T>::getRow(size_t row) const {
   checkBounds(row, 0);
-  std::vector<double> result(cols_);
-  for (size_t i = 0; i < cols_; ++i) {
-    result.push_back(data_[row][i]);
-  }
-  return result;
+  return std::vector<T>(rowData(row), rowData(row) + cols_);
 }
 
-std::vector<double> Matrix::getColumn(size_t column) {
+template <class T>
+std::vector<T> BasicMatrix<T>::getColumn(size_t column) const {
   checkBounds(0, column);
-  std::vector<double> result(cols_);
+  std::vector<T> result(rows_);
   for (size_t i = 0; i < rows_; ++i) {
-    result.push_back(data_[i][column]);
+    result[i] = rowData(i)[column];
   }
   return result;
 }
 
-bool Matrix::operator==(const Matrix& a) const {
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::view() {
+  return BasicMatrixView<T>(*this);
+}
+
+template <class T>
+BasicMatrixView<const T> BasicMatrix<T>::view() const {
+  return BasicMatrixView<const T>(*this);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::block(size_t row, size_t col, size_t rows, size_t cols) {
+  return view().block(row, col, rows, cols);
+}
+
+template <class T>
+BasicMatrixView<const T> BasicMatrix<T>::block(size_t row, size_t col,
+                                               size_t rows, size_t cols) const {
+  return view().block(row, col, rows, cols);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::rowView(size_t row) {
+  return view().rowView(row);
+}
+
+template <class T>
+BasicMatrixView<const T> BasicMatrix<T>::rowView(size_t row) const {
+  return view().rowView(row);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::columnView(size_t column) {
+  return view().columnView(column);
+}
+
+template <class T>
+BasicMatrixView<const T> BasicMatrix<T>::columnView(size_t column) const {
+  return view().columnView(column);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrix<T>::diagonalView() {
+  return view().diagonalView();
+}
+
+template <class T>
+BasicMatrixView<const T> BasicMatrix<T>::diagonalView() const {
+  return view().diagonalView();
+}
+
+template <class T>
+bool BasicMatrix<T>::operator==(const BasicMatrix& a) const {
   checkSize(a);
   for (size_t i = 0; i < rows_; ++i) {
+    const T* row = rowData(i);
+    const T* other = a.rowData(i);
     for (size_t j = 0; j < cols_; ++j) {
-      if (fabs(data_[i][j] - a[i][j]) >= EPS) {
+      if (!ElementTraits<T>::equal(row[j], other[j])) {
         return false;
       }
     }
@@ -249,98 +511,192 @@ bool Matrix::operator==(const Matrix& a) const {
   return true;
 }
 
-bool Matrix::operator!=(const Matrix& a) const {
+template <class T>
+bool BasicMatrix<T>::operator!=(const BasicMatrix& a) const {
   return !(*this == a);
 }
 
-void Matrix::checkBounds(const size_t& row, const size_t& col) const {
+template <class T>
+void BasicMatrix<T>::checkBounds(const size_t& row, const size_t& col) const {
   if (row >= rows_ || col >= cols_) {
     throw OutOfBoundsException();
   }
 }
 
-void Matrix::checkSize(const Matrix& a) const {
+template <class T>
+void BasicMatrix<T>::checkSize(const BasicMatrix& a) const {
   if (cols_ != a.cols_ || rows_ != a.rows_) {
     throw SizeMismatchException();
   }
 }
 
-double Matrix::det(const Matrix& matrix) const {
-  if (matrix.cols_ != matrix.rows_) {
-    throw SizeMismatchException();
-  }
-  double d = 0;
-  size_t rows = matrix.getRows();
-  size_t cols = matrix.getCols();
-
-  if (rows == 1) {
-    return matrix[0][0];
+// Cache-oblivious out-of-place transpose: halves the longer side until the
+// block fits in cache regardless of the cache size, then copies directly.
+template <class T>
+void BasicMatrix<T>::transposeBlock(const T* src, size_t src_stride,
+                                    T* dst, size_t dst_stride,
+                                    size_t rows, size_t cols) {
+  if (rows <= kTransposeLeaf && cols <= kTransposeLeaf) {
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t j = 0; j < cols; ++j) {
+        dst[j * dst_stride + i] = src[i * src_stride + j];
+      }
+    }
+  } else if (rows >= cols) {
+    const size_t half = rows / 2;
+    transposeBlock(src, src_stride, dst, dst_stride, half, cols);
+    transposeBlock(src + half * src_stride, src_stride, dst + half, dst_stride,
+                   rows - half, cols);
+  } else {
+    const size_t half = cols / 2;
+    transposeBlock(src, src_stride, dst, dst_stride, rows, half);
+    transposeBlock(src + half, src_stride, dst + half * dst_stride, dst_stride,
+                   rows, cols - half);
   }
+}
 
-  if (rows == 2) {
-    return matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0];
-  }
+template <class T>
+size_t BasicMatrix<T>::rowGrain() const {
+  return std::max<size_t>(1, parallel::kGrain / std::max<size_t>(cols_, 1));
+}
 
-  Matrix submatrix(rows - 1, cols - 1);
+template <class T>
+size_t BasicMatrix<T>::strideFor(size_t cols) {
+  const size_t per_line = std::max<size_t>(1, kAlignment / sizeof(T));
+  return (cols + per_line - 1) / per_line * per_line;
+}
 
-  for (size_t currentColumn = 0; currentColumn < cols; ++currentColumn) {
-    for (size_t i = 1; i < rows; ++i) {
-      for (size_t j = 0; j < cols; ++j) {
-        if (j == currentColumn) {
-          continue;
-        }
+template <class T>
+T* BasicMatrix<T>::allocate(size_t count) {
+  if (count == 0) {
+    return nullptr;
+  }
+  TASK_PROFILE_ALLOCATION(count * sizeof(T));
+  static_assert(kAlignment <= pool::kAlignment, "Pooled buffers are not aligned enough");
+  return static_cast<T*>(pool::acquire(count * sizeof(T)));
+}
 
-        submatrix[i - 1][j < currentColumn ? j : j - 1] = matrix[i][j];
-      }
-    }
+template <class T>
+void BasicMatrix<T>::deallocate(T* data, size_t count) {
+  pool::release(data, count * sizeof(T));
+}
 
-    d += pow(-1, currentColumn) * matrix[0][currentColumn] * det(submatrix);
+template <class T>
+void BasicMatrix<T>::allocSpace() {
+  data_ = allocate(rows_ * stride_);
+  if (data_ != nullptr) {
+    std::fill_n(data_, rows_ * stride_, T());
   }
-  return d;
 }
 
-void Matrix::allocSpace() {
-  data_ = new double*[rows_];
-  for (size_t i = 0; i < rows_; ++i) {
-    data_[i] = new double[cols_];
+template <class T>
+void BasicMatrix<T>::freeSpace() {
+  if (mapping_ != nullptr) {
+    unmap();
+  } else {
+    deallocate(data_, rows_ * stride_);
   }
+  data_ = nullptr;
 }
 
-size_t Matrix::getRows() const {
+template <class T>
+size_t BasicMatrix<T>::getRows() const {
   return rows_;
 }
 
-size_t Matrix::getCols() const {
+template <class T>
+size_t BasicMatrix<T>::getCols() const {
   return cols_;
 }
 
-Matrix task::operator*(const double& a, const Matrix& b) {
-  Matrix result(b);
-  result *= a;
-  return result;
+template <class T>
+size_t BasicMatrix<T>::getStride() const {
+  return stride_;
+}
+
+template <class T>
+T* BasicMatrix<T>::data() {
+  return data_;
 }
 
-std::ostream& task::operator<<(std::ostream& output, const Matrix& matrix) {
+template <class T>
+const T* BasicMatrix<T>::data() const {
+  return data_;
+}
+
+template <class T>
+BasicMatrix<T> task::operator+(BasicMatrix<T>&& a, BasicMatrix<T>&& b) {
+  a += b;
+  return std::move(a);
+}
+
+template <class T>
+BasicMatrix<T> task::operator-(BasicMatrix<T>&& a, BasicMatrix<T>&& b) {
+  a -= b;
+  return std::move(a);
+}
+
+template <class T>
+BasicMatrix<T> task::operator-(BasicMatrix<T>&& a) {
+  a *= T(-1);
+  return std::move(a);
+}
+
+template <class T>
+BasicMatrix<T> task::operator*(BasicMatrix<T>&& a,
+                               const typename BasicMatrix<T>::value_type& b) {
+  a *= b;
+  return std::move(a);
+}
+
+template <class T>
+BasicMatrix<T> task::operator*(const typename BasicMatrix<T>::value_type& a,
+                               BasicMatrix<T>&& b) {
+  b *= a;
+  return std::move(b);
+}
+
+template <class T>
+std::ostream& task::operator<<(std::ostream& output, const BasicMatrix<T>& matrix) {
+  TASK_PROFILE_SCOPE(kWrite, 0);
 
   for (size_t i = 0; i < matrix.getRows(); ++i) {
     for (size_t j = 0; j < matrix.getCols(); ++j) {
-      output << matrix[i][j] << " ";
+      output << matrix.unchecked(i, j) << " ";
     }
   }
 
   return output << "\n";
 }
 
-std::istream& task::operator>>(std::istream& input, Matrix& matrix) {
+template <class T>
+std::istream& task::operator>>(std::istream& input, BasicMatrix<T>& matrix) {
+  TASK_PROFILE_SCOPE(kRead, 0);
   size_t rows, cols;
-  double number;
+  T number;
   input >> rows >> cols;
   matrix.resize(rows, cols);
   for (size_t i = 0; i < rows; ++i) {
     for (size_t j = 0; j < cols; ++j) {
       input >> number;
-      matrix.set(i, j, number);
+      matrix.unchecked(i, j) = number;
     }
   }
   return input;
-}
\ No newline at end of file
+}
+
+#define TASK_INSTANTIATE_MATRIX(T)                                                 \
+  template class task::BasicMatrix<T>;                                             \
+  template BasicMatrix<T> task::operator+(BasicMatrix<T>&&, BasicMatrix<T>&&);     \
+  template BasicMatrix<T> task::operator-(BasicMatrix<T>&&, BasicMatrix<T>&&);     \
+  template BasicMatrix<T> task::operator-(BasicMatrix<T>&&);                       \
+  template BasicMatrix<T> task::operator*(BasicMatrix<T>&&, const T&);             \
+  template BasicMatrix<T> task::operator*(const T&, BasicMatrix<T>&&);             \
+  template std::ostream& task::operator<<(std::ostream&, const BasicMatrix<T>&);   \
+  template std::istream& task::operator>>(std::istream&, BasicMatrix<T>&);
+
+TASK_INSTANTIATE_MATRIX(double)
+TASK_INSTANTIATE_MATRIX(float)
+TASK_INSTANTIATE_MATRIX(int64_t)
+TASK_INSTANTIATE_MATRIX(std::complex<double>)
+TASK_INSTANTIATE_MATRIX(ModInt)
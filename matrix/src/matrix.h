@@ -1,83 +1,297 @@
 #pragma once
 
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <iostream>
+#include "modular.h"
+#include "profile.h"
 
 
 namespace task {
 
-const double EPS = 1e-6;
-
+constexpr double EPS = 1e-6;
 
 class OutOfBoundsException : public std::exception {};
 class SizeMismatchException : public std::exception {};
+class SingularMatrixException : public std::exception {};
+class IOException : public std::exception {};
+class FormatException : public std::exception {};
+
+
+// Element comparison used by operator==: integral (and other exact) types
+// compare exactly, floating point types within an absolute tolerance, EPS
+// for double and a looser one for float's shorter mantissa. kExact also
+// tells elimination whether pivots need choosing by magnitude.
+template <class T, class = void>
+struct ElementTraits {
+    static constexpr bool kExact = true;
+
+    static bool equal(const T& a, const T& b) { return a == b; }
+};
 
+template <class T>
+struct ElementTraits<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static constexpr bool kExact = false;
+    static constexpr T kTolerance = std::is_same_v<T, float> ? T(1e-3) : T(EPS);
+
+    static bool equal(const T& a, const T& b) { return std::fabs(a - b) < kTolerance; }
+};
+
+template <class T>
+struct ElementTraits<std::complex<T>> {
+    static constexpr bool kExact = false;
+
+    static bool equal(const std::complex<T>& a, const std::complex<T>& b) {
+        return std::abs(a - b) < ElementTraits<T>::kTolerance;
+    }
+};
 
-class Matrix {
+
+template <class E>
+class MatrixExpression;
+
+template <class T>
+class BasicMatrixView;
+
+
+// Dense row-major matrix of T. T must be trivially copyable with all-zero
+// bytes meaning zero (arithmetic types, std::complex, Modular); the supported types
+// are instantiated in matrix.cpp, see the aliases below.
+template <class T>
+class BasicMatrix {
+
+    static_assert(std::is_trivially_copyable_v<T>, "BasicMatrix needs a trivially copyable T");
 
 public:
 
-    Matrix();
-    Matrix(size_t rows, size_t cols);
-    Matrix(const Matrix& copy);
-    Matrix& operator=(const Matrix& a);
+    using value_type = T;
 
-    ~Matrix();
+    // Rows start on a 64-byte boundary: the buffer is aligned and the
+    // stride is padded up to a whole number of cache lines.
+    static constexpr size_t kAlignment = 64;
 
-    double& get(size_t row, size_t col);
-    const double& get(size_t row, size_t col) const;
-    void set(size_t row, size_t col, const double& value);
-    void resize(size_t new_rows, size_t new_cols);
+    class RowView {
+    public:
+        RowView(T* data, size_t size) : data_(data), size_(size) {}
+
+        T& operator[](size_t col) const { return data_[col]; }
+
+        T* data() const { return data_; }
+        size_t size() const { return size_; }
+        T* begin() const { return data_; }
+        T* end() const { return data_ + size_; }
+
+    private:
+        T* data_;
+        size_t size_;
+    };
 
-    double* operator[](size_t row);
-    double* operator[](size_t row) const;
+    class ConstRowView {
+    public:
+        ConstRowView(const T* data, size_t size) : data_(data), size_(size) {}
+        ConstRowView(const RowView& row) : data_(row.data()), size_(row.size()) {}
 
-    Matrix& operator+=(const Matrix& a);
-    Matrix& operator-=(const Matrix& a);
-    Matrix& operator*=(const Matrix& a);
-    Matrix& operator*=(const double& number);
+        const T& operator[](size_t col) const { return data_[col]; }
 
-    Matrix operator+(const Matrix& a) const;
-    Matrix operator-(const Matrix& a) const;
-    Matrix operator*(const Matrix& a) const;
-    Matrix operator*(const double& a) const;
+        const T* data() const { return data_; }
+        size_t size() const { return size_; }
+        const T* begin() const { return data_; }
+        const T* end() const { return data_ + size_; }
 
-    Matrix operator-() const;
-    Matrix operator+() const;
+    private:
+        const T* data_;
+        size_t size_;
+    };
 
-    double det() const;
+    BasicMatrix();
+    BasicMatrix(size_t rows, size_t cols);
+    BasicMatrix(const BasicMatrix& copy);
+    BasicMatrix& operator=(const BasicMatrix& a);
+    // A moved-from matrix is left empty, 0 x 0.
+    BasicMatrix(BasicMatrix&& other) noexcept;
+    BasicMatrix& operator=(BasicMatrix&& other) noexcept;
+
+    // Evaluates a lazy element-wise expression in a single pass.
+    template <class E>
+    BasicMatrix(const MatrixExpression<E>& expression);
+    template <class E>
+    BasicMatrix& operator=(const MatrixExpression<E>& expression);
+
+    ~BasicMatrix();
+
+    T& get(size_t row, size_t col);
+    const T& get(size_t row, size_t col) const;
+    void set(size_t row, size_t col, const T& value);
+    void resize(size_t new_rows, size_t new_cols);
+
+    // Inline and always checked: operator[] checks the row, operator()
+    // both indices. unchecked() is operator() without the check, for
+    // loops that have already checked their ranges.
+    RowView operator[](size_t row) {
+        checkBounds(row, 0);
+        return RowView(rowData(row), cols_);
+    }
+    ConstRowView operator[](size_t row) const {
+        checkBounds(row, 0);
+        return ConstRowView(rowData(row), cols_);
+    }
+    T& operator()(size_t row, size_t col) {
+        checkBounds(row, col);
+        return rowData(row)[col];
+    }
+    const T& operator()(size_t row, size_t col) const {
+        checkBounds(row, col);
+        return rowData(row)[col];
+    }
+    T& unchecked(size_t row, size_t col) { return rowData(row)[col]; }
+    const T& unchecked(size_t row, size_t col) const { return rowData(row)[col]; }
+
+    BasicMatrix& operator+=(const BasicMatrix& a);
+    BasicMatrix& operator-=(const BasicMatrix& a);
+    BasicMatrix& operator*=(const BasicMatrix& a);
+    BasicMatrix& operator*=(const T& number);
+    template <class E>
+    BasicMatrix& operator+=(const MatrixExpression<E>& expression);
+    template <class E>
+    BasicMatrix& operator-=(const MatrixExpression<E>& expression);
+
+    // Element-wise +, -, unary minus and scaling are lazy, see expression.h.
+    BasicMatrix operator*(const BasicMatrix& a) const &;
+    // Multiplies into this matrix's own storage when a is square.
+    BasicMatrix operator*(const BasicMatrix& a) &&;
+
+    // LU for double, Gaussian elimination with partial pivoting for the
+    // other floating point types and exact fraction-free (Bareiss)
+    // elimination for integral ones, which is exact as long as the
+    // intermediate minors fit into T. Modular elements are a field and get
+    // plain elimination on the first nonzero pivot.
+    T det() const;
+    // k-th power of a square matrix by repeated squaring: about 2 log2(k)
+    // products, all computed into three buffers allocated up front, so
+    // large powers of transfer matrices do not allocate per step. pow(0) is
+    // the identity. Throws SizeMismatchException for a non-square matrix.
+    BasicMatrix pow(uint64_t k) const;
+    // In place for square matrices.
     void transpose();
-    Matrix transposed() const;
-    double trace() const;
+    BasicMatrix transposed() const;
+    T trace() const;
 
-    std::vector<double> getRow(size_t row);
-    std::vector<double> getColumn(size_t column);
+    std::vector<T> getRow(size_t row) const;
+    std::vector<T> getColumn(size_t column) const;
 
-    bool operator==(const Matrix& a) const;
-    bool operator!=(const Matrix& a) const;
+    // Views into this matrix's storage, see matrix_view.h: the whole
+    // matrix, a rows x cols block at (row, col), one row, one column and
+    // the main diagonal as a column. Slices out of range throw
+    // OutOfBoundsException.
+    BasicMatrixView<T> view();
+    BasicMatrixView<const T> view() const;
+    BasicMatrixView<T> block(size_t row, size_t col, size_t rows, size_t cols);
+    BasicMatrixView<const T> block(size_t row, size_t col, size_t rows, size_t cols) const;
+    BasicMatrixView<T> rowView(size_t row);
+    BasicMatrixView<const T> rowView(size_t row) const;
+    BasicMatrixView<T> columnView(size_t column);
+    BasicMatrixView<const T> columnView(size_t column) const;
+    BasicMatrixView<T> diagonalView();
+    BasicMatrixView<const T> diagonalView() const;
+
+    bool operator==(const BasicMatrix& a) const;
+    bool operator!=(const BasicMatrix& a) const;
 
     size_t getRows() const;
     size_t getCols() const;
+    size_t getStride() const;
+
+    T* data();
+    const T* data() const;
+
+    // Binary format, see binary_io.h. load() reads the payload with one
+    // bulk read; mmap() maps the file copy-on-write instead of reading it,
+    // so pages are only loaded when touched and writes stay private.
+    // Both throw IOException and FormatException.
+    void save(const std::string& path) const;
+    static BasicMatrix load(const std::string& path);
+    static BasicMatrix mmap(const std::string& path);
+    bool isMapped() const;
+
+    // Row stride (in elements) used for a matrix with `cols` columns.
+    static size_t strideFor(size_t cols);
 
  private:
 
+    // Side of the square tiles both transposes bottom out in.
+    static constexpr size_t kTransposeLeaf = 16;
+
+    static void transposeBlock(const T* src, size_t src_stride,
+                               T* dst, size_t dst_stride,
+                               size_t rows, size_t cols);
+    static T* allocate(size_t count);
+    static void deallocate(T* data, size_t count);
+
+    T* rowData(size_t row) { return data_ + row * stride_; }
+    const T* rowData(size_t row) const { return data_ + row * stride_; }
+
+    // Rows per chunk when an element-wise loop is split across threads.
+    size_t rowGrain() const;
+
     void checkBounds(const size_t& row, const size_t& col) const;
-    void checkSize(const Matrix& a) const;
-    double det(const Matrix& a) const;
+    void checkSize(const BasicMatrix& a) const;
+    template <class E>
+    void assign(const E& expression);
     void allocSpace();
+    void freeSpace();
+    void unmap();
 
-    double** data_;
+    T* data_;
     size_t rows_;
     size_t cols_;
+    size_t stride_;
+    // Set when data_ points into a file mapping created by mmap().
+    void* mapping_ = nullptr;
+    size_t mapping_size_ = 0;
 
 };
 
 
-Matrix operator*(const double& a, const Matrix& b);
+using Matrix = BasicMatrix<double>;
+using MatrixF = BasicMatrix<float>;
+using MatrixI64 = BasicMatrix<int64_t>;
+using MatrixC = BasicMatrix<std::complex<double>>;
+// Modulo 1e9 + 7; save(), load() and mmap() are not available for it.
+using MatrixMod = BasicMatrix<ModInt>;
+
 
-std::ostream& operator<<(std::ostream& output, const Matrix& matrix);
-std::istream& operator>>(std::istream& input, Matrix& matrix);
+// Rvalue operands are about to die anyway, so these compute into their
+// storage and hand it back instead of allocating a result.
+template <class T>
+BasicMatrix<T> operator+(BasicMatrix<T>&& a, BasicMatrix<T>&& b);
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& a, BasicMatrix<T>&& b);
+template <class T>
+BasicMatrix<T> operator-(BasicMatrix<T>&& a);
+template <class T>
+BasicMatrix<T> operator*(BasicMatrix<T>&& a, const typename BasicMatrix<T>::value_type& b);
+template <class T>
+BasicMatrix<T> operator*(const typename BasicMatrix<T>::value_type& a, BasicMatrix<T>&& b);
 
+template <class T>
+std::ostream& operator<<(std::ostream& output, const BasicMatrix<T>& matrix);
+template <class T>
+std::istream& operator>>(std::istream& input, BasicMatrix<T>& matrix);
 
 
+extern template class BasicMatrix<double>;
+extern template class BasicMatrix<float>;
+extern template class BasicMatrix<int64_t>;
+extern template class BasicMatrix<std::complex<double>>;
+extern template class BasicMatrix<ModInt>;
+
 }  // namespace task
+
+#include "expression.h"
+#include "matrix_view.h"
+#include "static_matrix.h"
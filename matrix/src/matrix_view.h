@@ -0,0 +1,276 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "gemm.h"
+#include "thread_pool.h"
+
+
+// Non-owning views of a rectangular part of a matrix. A view is an
+// expression operand like a matrix, so `m.block(0, 0, 4, 4) + a` and
+// `m.rowView(2) * 2.0` fuse just like whole-matrix expressions, and
+// assigning to a view writes straight into the viewed matrix.
+//
+// A view refers to the matrix's storage: the matrix must outlive it and
+// must not be resized while the view is in use. This header is included
+// at the end of matrix.h.
+
+
+namespace task {
+
+// rows x cols elements of a matrix, element (i, j) at
+// data[i * rowStride() + j * colStride()]. BasicMatrixView<const T> is the
+// read-only flavour; every view converts to it. Assignment always writes
+// through to the elements, a view is never rebound.
+template <class T>
+class BasicMatrixView : public MatrixExpression<BasicMatrixView<T>> {
+
+    using Owner = std::conditional_t<std::is_const_v<T>,
+                                     const BasicMatrix<std::remove_const_t<T>>,
+                                     BasicMatrix<std::remove_const_t<T>>>;
+
+public:
+
+    using value_type = std::remove_const_t<T>;
+
+    static constexpr size_t kOperations = 0;
+
+    class Row {
+    public:
+        Row(T* data, size_t step) : data_(data), step_(step) {}
+
+        T& operator[](size_t col) const { return data_[col * step_]; }
+
+    private:
+        T* data_;
+        size_t step_;
+    };
+
+    BasicMatrixView(T* data, size_t rows, size_t cols, size_t row_stride, size_t col_stride = 1)
+        : data_(data), rows_(rows), cols_(cols), row_stride_(row_stride),
+          col_stride_(col_stride) {}
+    // The whole of `matrix`.
+    BasicMatrixView(Owner& matrix)
+        : BasicMatrixView(matrix.data(), matrix.getRows(), matrix.getCols(),
+                          matrix.getStride()) {}
+    template <class U, class = std::enable_if_t<std::is_same_v<const U, T>>>
+    BasicMatrixView(const BasicMatrixView<U>& view)
+        : BasicMatrixView(view.data(), view.getRows(), view.getCols(), view.rowStride(),
+                          view.colStride()) {}
+    BasicMatrixView(const BasicMatrixView& view) = default;
+
+    // The source must have the same shape and must not partially overlap
+    // the view; any other matrix operand or expression is fine.
+    BasicMatrixView& operator=(const BasicMatrixView& source);
+    template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+    BasicMatrixView& operator=(const E& source);
+    template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+    BasicMatrixView& operator+=(const E& source);
+    template <class E, class = std::enable_if_t<IsMatrixOperand<E>::value>>
+    BasicMatrixView& operator-=(const E& source);
+    BasicMatrixView& operator*=(const value_type& number);
+
+    T& get(size_t row, size_t col) const;
+    Row operator[](size_t row) const { return this->row(row); }
+    Row row(size_t i) const { return Row(data_ + i * row_stride_, col_stride_); }
+
+    // The same slices a matrix offers, relative to this view. Out of range
+    // slices throw OutOfBoundsException.
+    BasicMatrixView block(size_t row, size_t col, size_t rows, size_t cols) const;
+    BasicMatrixView rowView(size_t row) const;
+    BasicMatrixView columnView(size_t col) const;
+    // The main diagonal as a column.
+    BasicMatrixView diagonalView() const;
+    BasicMatrixView transposed() const;
+
+    size_t getRows() const { return rows_; }
+    size_t getCols() const { return cols_; }
+    size_t rowStride() const { return row_stride_; }
+    size_t colStride() const { return col_stride_; }
+    T* data() const { return data_; }
+    bool overlaps(const void* begin, const void* end) const;
+
+ private:
+
+    template <class E, class Op>
+    void update(const E& source, Op op);
+
+    T* data_;
+    size_t rows_;
+    size_t cols_;
+    size_t row_stride_;
+    size_t col_stride_;
+
+};
+
+
+using MatrixView = BasicMatrixView<double>;
+using ConstMatrixView = BasicMatrixView<const double>;
+
+
+template <class T>
+BasicMatrixView<T>& BasicMatrixView<T>::operator=(const BasicMatrixView& source) {
+    update(source, [](value_type& out, const value_type& value) { out = value; });
+    return *this;
+}
+
+template <class T>
+template <class E, class>
+BasicMatrixView<T>& BasicMatrixView<T>::operator=(const E& source) {
+    update(asOperand(source), [](value_type& out, const value_type& value) { out = value; });
+    return *this;
+}
+
+template <class T>
+template <class E, class>
+BasicMatrixView<T>& BasicMatrixView<T>::operator+=(const E& source) {
+    update(asOperand(source), [](value_type& out, const value_type& value) { out += value; });
+    return *this;
+}
+
+template <class T>
+template <class E, class>
+BasicMatrixView<T>& BasicMatrixView<T>::operator-=(const E& source) {
+    update(asOperand(source), [](value_type& out, const value_type& value) { out -= value; });
+    return *this;
+}
+
+template <class T>
+BasicMatrixView<T>& BasicMatrixView<T>::operator*=(const value_type& number) {
+    const BasicMatrixView& self = *this;
+    update(self, [&](value_type& out, const value_type&) { out *= number; });
+    return *this;
+}
+
+template <class T>
+T& BasicMatrixView<T>::get(size_t row, size_t col) const {
+    if (row >= rows_ || col >= cols_) {
+        throw OutOfBoundsException();
+    }
+    return data_[row * row_stride_ + col * col_stride_];
+}
+
+template <class T>
+bool BasicMatrixView<T>::overlaps(const void* begin, const void* end) const {
+    if (rows_ == 0 || cols_ == 0) {
+        return false;
+    }
+    // Unrelated buffers are compared too, hence std::less.
+    const T* last = data_ + (rows_ - 1) * row_stride_ + (cols_ - 1) * col_stride_;
+    const std::less<const void*> less;
+    return less(data_, end) && !less(last, begin);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::block(size_t row, size_t col,
+                                             size_t rows, size_t cols) const {
+    if (row > rows_ || rows > rows_ - row || col > cols_ || cols > cols_ - col) {
+        throw OutOfBoundsException();
+    }
+    return BasicMatrixView(data_ + row * row_stride_ + col * col_stride_, rows, cols,
+                           row_stride_, col_stride_);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::rowView(size_t row) const {
+    return block(row, 0, 1, cols_);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::columnView(size_t col) const {
+    return block(0, col, rows_, 1);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::diagonalView() const {
+    // A column whose rows step along the diagonal.
+    return BasicMatrixView(data_, std::min(rows_, cols_), 1, row_stride_ + col_stride_,
+                           col_stride_);
+}
+
+template <class T>
+BasicMatrixView<T> BasicMatrixView<T>::transposed() const {
+    return BasicMatrixView(data_, cols_, rows_, col_stride_, row_stride_);
+}
+
+template <class T>
+template <class E, class Op>
+void BasicMatrixView<T>::update(const E& source, Op op) {
+    static_assert(!std::is_const_v<T>, "Cannot write through a read-only view");
+    static_assert(std::is_same_v<value_type, typename E::value_type>,
+                  "Expression and view need the same element type");
+    if (rows_ != source.getRows() || cols_ != source.getCols()) {
+        throw SizeMismatchException();
+    }
+    const size_t grain = std::max<size_t>(1, parallel::kGrain / std::max<size_t>(1, cols_));
+    parallel::forRange(rows_, grain, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Row out = row(i);
+            const auto in = source.row(i);
+            for (size_t j = 0; j < cols_; ++j) {
+                op(out[j], in[j]);
+            }
+        }
+    });
+}
+
+
+namespace detail {
+
+// Product of two read-only views. Views whose elements are contiguous
+// within a row go to gemm in place; transposed ones are copied first.
+template <class T>
+BasicMatrix<T> multiplyViews(const BasicMatrixView<const T>& a,
+                             const BasicMatrixView<const T>& b) {
+    if (a.getCols() != b.getRows()) {
+        throw SizeMismatchException();
+    }
+    if (a.colStride() != 1 && a.getCols() > 1) {
+        const BasicMatrix<T> copy(a);
+        return multiplyViews<T>(copy, b);
+    }
+    if (b.colStride() != 1 && b.getCols() > 1) {
+        const BasicMatrix<T> copy(b);
+        return multiplyViews<T>(a, copy);
+    }
+    BasicMatrix<T> result(a.getRows(), b.getCols());
+    std::fill_n(result.data(), result.getRows() * result.getStride(), T());
+    gemm::multiply(a.getRows(), b.getCols(), a.getCols(), a.data(), a.rowStride(),
+                   b.data(), b.rowStride(), result.data(), result.getStride());
+    return result;
+}
+
+// Product operands: matrices and views are used in place, lazy
+// expressions are evaluated.
+template <class T>
+const BasicMatrix<T>& productOperand(const BasicMatrix<T>& matrix) {
+    return matrix;
+}
+
+template <class T>
+BasicMatrixView<T> productOperand(const BasicMatrixView<T>& view) {
+    return view;
+}
+
+template <class E>
+BasicMatrix<typename E::value_type> productOperand(const MatrixExpression<E>& expression) {
+    return BasicMatrix<typename E::value_type>(expression);
+}
+
+}  // namespace detail
+
+
+// Products with at least one view operand.
+template <class L, class R, std::enable_if_t<
+    IsMatrixOperand<L>::value && IsMatrixOperand<R>::value &&
+    (IsMatrixView<L>::value || IsMatrixView<R>::value), int> = 0>
+BasicMatrix<ValueType<L>> operator*(const L& lhs, const R& rhs) {
+    static_assert(std::is_same_v<ValueType<L>, ValueType<R>>,
+                  "Factors of a product need the same element type");
+    const auto& left = detail::productOperand(lhs);
+    const auto& right = detail::productOperand(rhs);
+    return detail::multiplyViews<ValueType<L>>(left, right);
+}
+
+}  // namespace task
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+
+
+namespace task {
+
+// Integer modulo Mod, kept reduced to [0, Mod). With a prime Mod it is a
+// field, so det() and division work as for real numbers; matrices of it
+// count paths, tilings and other recurrences modulo Mod without overflow.
+// All-zero bytes are zero, so it can be a BasicMatrix element.
+template <uint32_t Mod>
+class Modular {
+
+    static_assert(Mod > 1 && Mod <= (1u << 31), "Modular needs 1 < Mod <= 2^31");
+
+public:
+
+    static constexpr uint32_t kModulus = Mod;
+
+    constexpr Modular() : value_(0) {}
+    constexpr Modular(int64_t value) : value_(reduce(value)) {}
+
+    constexpr uint32_t value() const { return value_; }
+
+    constexpr Modular& operator+=(Modular a) {
+        value_ += a.value_;
+        if (value_ >= Mod) {
+            value_ -= Mod;
+        }
+        return *this;
+    }
+    constexpr Modular& operator-=(Modular a) {
+        value_ += Mod - a.value_;
+        if (value_ >= Mod) {
+            value_ -= Mod;
+        }
+        return *this;
+    }
+    constexpr Modular& operator*=(Modular a) {
+        value_ = static_cast<uint32_t>(static_cast<uint64_t>(value_) * a.value_ % Mod);
+        return *this;
+    }
+    // Multiplies by a.inverse(), see there.
+    constexpr Modular& operator/=(Modular a) {
+        return *this *= a.inverse();
+    }
+
+    constexpr Modular pow(uint64_t k) const {
+        Modular result(1), base(*this);
+        for (; k > 0; k >>= 1) {
+            if (k & 1) {
+                result *= base;
+            }
+            base *= base;
+        }
+        return result;
+    }
+    // By Fermat's little theorem, so only meaningful for a prime Mod; the
+    // inverse of zero comes out as zero.
+    constexpr Modular inverse() const {
+        return pow(Mod - 2);
+    }
+
+    constexpr Modular operator-() const { return Modular() - *this; }
+    constexpr Modular operator+() const { return *this; }
+
+    friend constexpr Modular operator+(Modular a, Modular b) { return a += b; }
+    friend constexpr Modular operator-(Modular a, Modular b) { return a -= b; }
+    friend constexpr Modular operator*(Modular a, Modular b) { return a *= b; }
+    friend constexpr Modular operator/(Modular a, Modular b) { return a /= b; }
+    friend constexpr bool operator==(Modular a, Modular b) { return a.value_ == b.value_; }
+    friend constexpr bool operator!=(Modular a, Modular b) { return a.value_ != b.value_; }
+
+    friend std::ostream& operator<<(std::ostream& output, Modular a) {
+        return output << a.value_;
+    }
+    friend std::istream& operator>>(std::istream& input, Modular& a) {
+        int64_t value;
+        if (input >> value) {
+            a = Modular(value);
+        }
+        return input;
+    }
+
+ private:
+
+    static constexpr uint32_t reduce(int64_t value) {
+        const int64_t rest = value % static_cast<int64_t>(Mod);
+        return static_cast<uint32_t>(rest < 0 ? rest + Mod : rest);
+    }
+
+    uint32_t value_;
+
+};
+
+
+// The usual prime for counting problems.
+constexpr uint32_t kPrimeModulus = 1000000007;
+using ModInt = Modular<kPrimeModulus>;
+
+}  // namespace task
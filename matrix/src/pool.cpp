@@ -0,0 +1,156 @@
+#include "pool.h"
+
+#include <new>
+#include <vector>
+
+using namespace task;
+using namespace task::pool;
+
+namespace {
+
+// The smallest class; everything up to it shares one.
+const size_t kMinBytes = 64;
+
+constexpr unsigned log2(size_t value) {
+  return value <= 1 ? 0 : 1 + log2(value / 2);
+}
+
+const size_t kClasses = 1 + 4 * (log2(kMaxPooledBytes) - log2(kMinBytes));
+
+// Index of the size class of a request of `bytes` bytes, 0 < bytes <=
+// kMaxPooledBytes, and the capacity buffers of that class have. Above
+// kMinBytes every power-of-two range (2^b, 2^(b+1)] splits into four.
+size_t classOf(size_t bytes, size_t* capacity) {
+  if (bytes <= kMinBytes) {
+    *capacity = kMinBytes;
+    return 0;
+  }
+  const unsigned bits = 63 - __builtin_clzll(bytes - 1);
+  const size_t step = (size_t(1) << bits) / 4;
+  const size_t steps = (bytes - 1) / step + 1;
+  *capacity = steps * step;
+  return 1 + (bits - log2(kMinBytes)) * 4 + (steps - 5);
+}
+
+void* allocate(size_t bytes) {
+  return ::operator new(bytes, std::align_val_t(kAlignment));
+}
+
+void deallocate(void* data) {
+  ::operator delete(data, std::align_val_t(kAlignment));
+}
+
+struct Cache {
+  Cache();
+  ~Cache();
+
+  std::vector<void*> lists[kClasses];
+  Stats stats;
+};
+
+// Matrices with static storage duration outlive the main thread's cache;
+// once it is gone they bypass it.
+enum class Status : unsigned char { kUnused, kAlive, kDestroyed };
+thread_local Status status = Status::kUnused;
+
+Cache::Cache() {
+  // Releasing then never allocates.
+  for (std::vector<void*>& list : lists) {
+    list.reserve(kMaxPerClass);
+  }
+  status = Status::kAlive;
+}
+
+Cache::~Cache() {
+  for (std::vector<void*>& list : lists) {
+    for (void* data : list) {
+      deallocate(data);
+    }
+  }
+  status = Status::kDestroyed;
+}
+
+// Null once the calling thread's cache has been destroyed.
+Cache* localCache() {
+  if (status == Status::kDestroyed) {
+    return nullptr;
+  }
+  thread_local Cache cache;
+  return &cache;
+}
+
+}  // namespace
+
+void* pool::acquire(size_t bytes) {
+  if (bytes == 0) {
+    return nullptr;
+  }
+  Cache* cache = localCache();
+  if (!kEnabled || bytes > kMaxPooledBytes || cache == nullptr) {
+    if (cache != nullptr) {
+      ++cache->stats.misses;
+    }
+    return allocate(bytes);
+  }
+  size_t capacity;
+  std::vector<void*>& list = cache->lists[classOf(bytes, &capacity)];
+  if (list.empty()) {
+    ++cache->stats.misses;
+    return allocate(capacity);
+  }
+  ++cache->stats.hits;
+  cache->stats.cached_bytes -= capacity;
+  void* data = list.back();
+  list.pop_back();
+  return data;
+}
+
+void pool::release(void* data, size_t bytes) {
+  if (data == nullptr) {
+    return;
+  }
+  Cache* cache = localCache();
+  if (kEnabled && bytes <= kMaxPooledBytes && cache != nullptr) {
+    size_t capacity;
+    std::vector<void*>& list = cache->lists[classOf(bytes, &capacity)];
+    if (list.size() < kMaxPerClass &&
+        cache->stats.cached_bytes + capacity <= kMaxCachedBytes) {
+      list.push_back(data);
+      ++cache->stats.cached;
+      cache->stats.cached_bytes += capacity;
+      return;
+    }
+  }
+  if (cache != nullptr) {
+    ++cache->stats.freed;
+  }
+  deallocate(data);
+}
+
+Stats pool::stats() {
+  Cache* cache = localCache();
+  return cache != nullptr ? cache->stats : Stats();
+}
+
+void pool::resetStats() {
+  Cache* cache = localCache();
+  if (cache != nullptr) {
+    const size_t cached_bytes = cache->stats.cached_bytes;
+    cache->stats = Stats();
+    cache->stats.cached_bytes = cached_bytes;
+  }
+}
+
+void pool::trim() {
+  Cache* cache = localCache();
+  if (cache == nullptr) {
+    return;
+  }
+  for (std::vector<void*>& list : cache->lists) {
+    for (void* data : list) {
+      deallocate(data);
+    }
+    list.clear();
+  }
+  cache->stats.cached_bytes = 0;
+}
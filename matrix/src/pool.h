@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+// Recycling of BasicMatrix storage. Freed buffers go into a per-thread
+// cache sorted by size class (four classes per power of two, so at most a
+// quarter of a buffer is slack), and the next matrix of that class takes
+// one back instead of calling operator new; temporaries in a loop such as
+// `c = a * b + d` then stop allocating after the first iteration. Build
+// with -DTASK_MATRIX_POOL=0 to go straight to operator new and delete;
+// stats() still counts the allocations then.
+#ifndef TASK_MATRIX_POOL
+#define TASK_MATRIX_POOL 1
+#endif
+
+
+namespace task {
+namespace pool {
+
+constexpr bool kEnabled = TASK_MATRIX_POOL;
+
+// Every buffer starts on a boundary of this many bytes.
+constexpr size_t kAlignment = 64;
+// Larger buffers bypass the cache: allocating them costs little next to
+// the work done on them.
+constexpr size_t kMaxPooledBytes = size_t(64) << 20;
+// Caps on what one thread keeps; a release beyond them frees the buffer.
+constexpr size_t kMaxCachedBytes = size_t(256) << 20;
+constexpr size_t kMaxPerClass = 8;
+
+struct Stats {
+    // acquire() calls served from the cache and sent to operator new.
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    // release() calls that kept the buffer and that freed it.
+    uint64_t cached = 0;
+    uint64_t freed = 0;
+    // Bytes held in the cache right now.
+    size_t cached_bytes = 0;
+};
+
+// A buffer of at least `bytes` bytes aligned to kAlignment, nullptr for 0.
+void* acquire(size_t bytes);
+// Hands back a buffer from acquire() with the same `bytes`. Any thread
+// may release it, into its own cache.
+void release(void* data, size_t bytes);
+
+// Counters of the calling thread since it started or called resetStats().
+Stats stats();
+void resetStats();
+// Frees every buffer cached by the calling thread.
+void trim();
+
+}  // namespace pool
+}  // namespace task
@@ -0,0 +1,144 @@
+#include "profile.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+using namespace task;
+using namespace task::profile;
+
+namespace {
+
+const size_t kOperations = static_cast<size_t>(Operation::kCount);
+
+struct AtomicCounters {
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> flops{0};
+  std::atomic<uint64_t> bytes{0};
+  std::atomic<uint64_t> nanoseconds{0};
+};
+
+AtomicCounters totals[kOperations];
+
+// The operation of the outermost Scope open on this thread.
+thread_local Operation current = Operation::kOther;
+thread_local bool inside_scope = false;
+
+AtomicCounters& totalsOf(Operation operation) {
+  return totals[static_cast<size_t>(operation)];
+}
+
+// Prints the report when the program exits.
+struct ExitReport {
+  ~ExitReport() {
+    if (!kEnabled) {
+      return;
+    }
+    const char* path = std::getenv("TASK_MATRIX_PROFILE_JSON");
+    if (path == nullptr) {
+      report(std::cerr);
+      return;
+    }
+    std::ofstream output(path);
+    report(output, true);
+  }
+} exit_report;
+
+}  // namespace
+
+const char* profile::name(Operation operation) {
+  switch (operation) {
+    case Operation::kProduct: return "product";
+    case Operation::kElementwise: return "elementwise";
+    case Operation::kDet: return "det";
+    case Operation::kTranspose: return "transpose";
+    case Operation::kResize: return "resize";
+    case Operation::kRead: return "read";
+    case Operation::kWrite: return "write";
+    case Operation::kOther: return "other";
+    case Operation::kCount: break;
+  }
+  return "unknown";
+}
+
+Counters profile::counters(Operation operation) {
+  const AtomicCounters& source = totalsOf(operation);
+  Counters result;
+  result.calls = source.calls.load();
+  result.flops = source.flops.load();
+  result.bytes = source.bytes.load();
+  result.seconds = source.nanoseconds.load() * 1e-9;
+  return result;
+}
+
+void profile::reset() {
+  for (AtomicCounters& counters : totals) {
+    counters.calls = 0;
+    counters.flops = 0;
+    counters.bytes = 0;
+    counters.nanoseconds = 0;
+  }
+}
+
+void profile::report(std::ostream& output, bool json) {
+  if (json) {
+    output << "{\"operations\": [";
+  } else {
+    output << std::left << std::setw(12) << "operation" << std::right
+           << std::setw(12) << "calls" << std::setw(14) << "MFLOP"
+           << std::setw(14) << "MB allocated" << std::setw(12) << "seconds"
+           << std::setw(12) << "GFLOP/s" << '\n';
+  }
+  bool first = true;
+  for (size_t i = 0; i < kOperations; ++i) {
+    const Operation operation = static_cast<Operation>(i);
+    const Counters total = counters(operation);
+    if (total.calls == 0 && total.bytes == 0) {
+      continue;
+    }
+    if (json) {
+      output << (first ? "" : ", ") << "{\"name\": \"" << name(operation)
+             << "\", \"calls\": " << total.calls << ", \"flops\": " << total.flops
+             << ", \"bytes\": " << total.bytes << ", \"seconds\": " << total.seconds << '}';
+    } else {
+      const double rate = total.seconds > 0. ? total.flops / total.seconds * 1e-9 : 0.;
+      output << std::left << std::setw(12) << name(operation) << std::right
+             << std::setw(12) << total.calls << std::fixed << std::setprecision(3)
+             << std::setw(14) << total.flops * 1e-6 << std::setw(14) << total.bytes * 1e-6
+             << std::setw(12) << total.seconds << std::setw(12) << rate
+             << std::defaultfloat << '\n';
+    }
+    first = false;
+  }
+  if (json) {
+    output << "]}\n";
+  }
+}
+
+Scope::Scope(Operation operation, uint64_t flops)
+    : operation_(operation), flops_(flops), outermost_(!inside_scope) {
+  if (outermost_) {
+    inside_scope = true;
+    current = operation;
+    start_ = std::chrono::steady_clock::now();
+  }
+}
+
+Scope::~Scope() {
+  if (!outermost_) {
+    return;
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start_;
+  AtomicCounters& total = totalsOf(operation_);
+  total.calls += 1;
+  total.flops += flops_;
+  total.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+  inside_scope = false;
+  current = Operation::kOther;
+}
+
+void profile::recordAllocation(size_t bytes) {
+  totalsOf(current).bytes += bytes;
+}
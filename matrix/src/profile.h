@@ -0,0 +1,86 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+
+// Opt-in instrumentation of BasicMatrix operations: calls, floating point
+// operations, bytes of matrix storage allocated and wall time, per kind of
+// operation. Build every translation unit with -DTASK_MATRIX_PROFILE=1 to
+// turn it on; the program then prints a table to stderr at exit, or JSON
+// into the file named by the TASK_MATRIX_PROFILE_JSON environment variable.
+// Otherwise the hooks below expand to nothing and their arguments are never
+// evaluated, so release builds can keep them.
+#ifndef TASK_MATRIX_PROFILE
+#define TASK_MATRIX_PROFILE 0
+#endif
+
+
+namespace task {
+namespace profile {
+
+constexpr bool kEnabled = TASK_MATRIX_PROFILE;
+
+enum class Operation {
+    kProduct,      // Matrix products: *, *= and pow()
+    kElementwise,  // +, -, scaling and negation, lazy or compound
+    kDet,
+    kTranspose,    // transpose() and transposed()
+    kResize,
+    kRead,         // operator>> and load()
+    kWrite,        // operator<< and save()
+    kOther,        // allocations made outside the operations above
+    kCount,
+};
+
+struct Counters {
+    uint64_t calls = 0;
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+    double seconds = 0.;
+};
+
+const char* name(Operation operation);
+// Totals since the start of the program or the last reset(); always zero
+// unless kEnabled.
+Counters counters(Operation operation);
+void reset();
+// One row (or JSON object) per operation that was called or allocated.
+void report(std::ostream& output, bool json = false);
+
+// Counts one call of `operation` doing `flops` floating point operations
+// and times it until the end of the scope. Operations nest: a Scope opened
+// while another one is open on the same thread is part of the outer
+// operation and records nothing, so `a * b` inside det() is not counted
+// twice.
+class Scope {
+public:
+    Scope(Operation operation, uint64_t flops);
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    ~Scope();
+
+private:
+    Operation operation_;
+    uint64_t flops_;
+    bool outermost_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Adds `bytes` to the operation open on this thread, kOther if none is.
+void recordAllocation(size_t bytes);
+
+}  // namespace profile
+}  // namespace task
+
+
+#if TASK_MATRIX_PROFILE
+#define TASK_PROFILE_SCOPE(operation, flops) \
+    ::task::profile::Scope task_profile_scope_(::task::profile::Operation::operation, (flops))
+#define TASK_PROFILE_ALLOCATION(bytes) ::task::profile::recordAllocation(bytes)
+#else
+#define TASK_PROFILE_SCOPE(operation, flops) static_cast<void>(0)
+#define TASK_PROFILE_ALLOCATION(bytes) static_cast<void>(0)
+#endif
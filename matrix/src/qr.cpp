@@ -0,0 +1,252 @@
+#include "qr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace task;
+
+namespace {
+
+// Applies the reflector H = I - tau * v * v^T to `count` rows of x (`cols`
+// values each, `ldx` apart). v has `count` elements `vstride` apart, the
+// first of which is taken to be 1. `w` holds `cols` values of scratch.
+// Works a whole row of x at a time.
+void reflect(const double* v, size_t vstride, size_t count, double tau,
+             double* x, size_t ldx, size_t cols, double* w) {
+  if (tau == 0.0 || cols == 0) {
+    return;
+  }
+  std::copy(x, x + cols, w);
+  for (size_t i = 1; i < count; ++i) {
+    const double factor = v[i * vstride];
+    const double* row = x + i * ldx;
+    for (size_t j = 0; j < cols; ++j) {
+      w[j] += factor * row[j];
+    }
+  }
+  for (size_t j = 0; j < cols; ++j) {
+    w[j] *= tau;
+    x[j] -= w[j];
+  }
+  for (size_t i = 1; i < count; ++i) {
+    const double factor = v[i * vstride];
+    double* row = x + i * ldx;
+    for (size_t j = 0; j < cols; ++j) {
+      row[j] -= factor * w[j];
+    }
+  }
+}
+
+}  // namespace
+
+QR::QR(const Matrix& matrix)
+    : qr_(matrix), tau_(matrix.getCols()), rows_(matrix.getRows()),
+      cols_(matrix.getCols()) {
+  if (rows_ < cols_) {
+    throw SizeMismatchException();
+  }
+  factorize();
+}
+
+// Blocked Householder: factorize a panel of kPanel columns reflector by
+// reflector, then apply all of its reflectors to the columns on its right
+// at once as I - V * T * V^T, which is two gemm calls.
+void QR::factorize() {
+  for (size_t k = 0; k < cols_; k += kPanel) {
+    const size_t width = std::min(kPanel, cols_ - k);
+    factorizePanel(k, width);
+    if (k + width < cols_) {
+      applyPanel(k, width);
+    }
+  }
+}
+
+// Unblocked factorization of columns [k, k + width), rows k and below.
+void QR::factorizePanel(size_t k, size_t width) {
+  double* data = qr_.data();
+  const size_t stride = qr_.getStride();
+  std::vector<double> scratch(width);
+  for (size_t c = k; c < k + width; ++c) {
+    double* column = data + c * stride + c;
+    const size_t count = rows_ - c;
+    double tail = 0.0;
+    for (size_t i = 1; i < count; ++i) {
+      tail += column[i * stride] * column[i * stride];
+    }
+    tau_[c] = 0.0;
+    if (tail == 0.0) {
+      continue;
+    }
+
+    // Reflect the column onto beta * e1, with beta of the opposite sign to
+    // the diagonal element so computing v does not cancel.
+    const double alpha = column[0];
+    const double norm = std::sqrt(alpha * alpha + tail);
+    const double beta = alpha > 0.0 ? -norm : norm;
+    tau_[c] = (beta - alpha) / beta;
+    const double scale = 1.0 / (alpha - beta);
+    for (size_t i = 1; i < count; ++i) {
+      column[i * stride] *= scale;
+    }
+    column[0] = beta;
+
+    reflect(column, stride, count, tau_[c], column + 1, stride,
+            k + width - c - 1, scratch.data());
+  }
+}
+
+// A2 <- (I - V * T * V^T)^T * A2 for the trailing columns A2, where V holds
+// the panel's reflectors and T is the upper triangle that makes
+// H(k) * ... * H(k + width - 1) = I - V * T * V^T.
+void QR::applyPanel(size_t k, size_t width) {
+  const size_t count = rows_ - k;
+  const size_t start = k + width;
+  const size_t rest = cols_ - start;
+
+  Matrix v(count, width);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < width; ++j) {
+      v.unchecked(i, j) = i > j ? qr_.unchecked(k + i, k + j) : (i == j ? 1.0 : 0.0);
+    }
+  }
+
+  // Column j of T is -tau_j * T * (V^T v_j) above the diagonal.
+  const Matrix v_transposed = v.transposed();
+  const Matrix gram = v_transposed * v;
+  Matrix t(width, width);
+  for (size_t j = 0; j < width; ++j) {
+    const double tau = tau_[k + j];
+    for (size_t i = 0; i < j; ++i) {
+      double sum = 0.0;
+      for (size_t p = i; p < j; ++p) {
+        sum += t[i][p] * gram[p][j];
+      }
+      t[i][j] = -tau * sum;
+    }
+    t[j][j] = tau;
+  }
+
+  // W = T^T * (V^T * A2), bottom row first so T^T can work in place.
+  Matrix w = v_transposed * qr_.block(k, start, count, rest);
+  for (size_t i = width; i-- > 0;) {
+    double* out = &w[i][0];
+    const double diagonal = t[i][i];
+    for (size_t j = 0; j < rest; ++j) {
+      out[j] *= diagonal;
+    }
+    for (size_t p = 0; p < i; ++p) {
+      const double factor = t[p][i];
+      const double* source = &w[p][0];
+      for (size_t j = 0; j < rest; ++j) {
+        out[j] += factor * source[j];
+      }
+    }
+  }
+
+  qr_.block(k, start, count, rest) -= v * w;
+}
+
+bool QR::isRankDeficient() const {
+  double largest = 0.0;
+  for (size_t i = 0; i < cols_; ++i) {
+    largest = std::max(largest, std::fabs(qr_[i][i]));
+  }
+  // Relative to the largest, so scaling A does not change the answer.
+  const double threshold =
+      largest * std::numeric_limits<double>::epsilon() * std::max<size_t>(rows_, 1);
+  for (size_t i = 0; i < cols_; ++i) {
+    if (std::fabs(qr_[i][i]) <= threshold) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void QR::applyTransposedQ(double* x, size_t ldx, size_t cols) const {
+  const double* data = qr_.data();
+  const size_t stride = qr_.getStride();
+  std::vector<double> scratch(cols);
+  for (size_t c = 0; c < cols_; ++c) {
+    reflect(data + c * stride + c, stride, rows_ - c, tau_[c],
+            x + c * ldx, ldx, cols, scratch.data());
+  }
+}
+
+// Back substitution with R on the first cols_ rows of x.
+void QR::substitute(double* x, size_t ldx, size_t cols) const {
+  if (isRankDeficient()) {
+    throw SingularMatrixException();
+  }
+  const double* data = qr_.data();
+  const size_t stride = qr_.getStride();
+  for (size_t i = cols_; i-- > 0;) {
+    const double* upper = data + i * stride;
+    double* out = x + i * ldx;
+    for (size_t k = i + 1; k < cols_; ++k) {
+      const double factor = upper[k];
+      const double* solved = x + k * ldx;
+      for (size_t j = 0; j < cols; ++j) {
+        out[j] -= factor * solved[j];
+      }
+    }
+    const double inv_diagonal = 1.0 / upper[i];
+    for (size_t j = 0; j < cols; ++j) {
+      out[j] *= inv_diagonal;
+    }
+  }
+}
+
+Matrix QR::solve(const Matrix& b) const {
+  if (b.getRows() != rows_) {
+    throw SizeMismatchException();
+  }
+  Matrix y(b);
+  applyTransposedQ(y.data(), y.getStride(), y.getCols());
+  substitute(y.data(), y.getStride(), y.getCols());
+  return Matrix(y.block(0, 0, cols_, y.getCols()));
+}
+
+std::vector<double> QR::solve(const std::vector<double>& b) const {
+  if (b.size() != rows_) {
+    throw SizeMismatchException();
+  }
+  std::vector<double> y(b);
+  applyTransposedQ(y.data(), 1, 1);
+  substitute(y.data(), 1, 1);
+  y.resize(cols_);
+  return y;
+}
+
+size_t QR::getRows() const {
+  return rows_;
+}
+
+size_t QR::getCols() const {
+  return cols_;
+}
+
+// Q = H(0) * ... * H(cols - 1) times the first cols columns of the
+// identity, last reflector first.
+Matrix QR::q() const {
+  Matrix result(rows_, cols_);
+  const double* data = qr_.data();
+  const size_t stride = qr_.getStride();
+  std::vector<double> scratch(cols_);
+  for (size_t c = cols_; c-- > 0;) {
+    reflect(data + c * stride + c, stride, rows_ - c, tau_[c],
+            result.data() + c * result.getStride(), result.getStride(), cols_,
+            scratch.data());
+  }
+  return result;
+}
+
+Matrix QR::r() const {
+  Matrix result(cols_, cols_);
+  for (size_t i = 0; i < cols_; ++i) {
+    for (size_t j = 0; j < cols_; ++j) {
+      result.unchecked(i, j) = j >= i ? qr_.unchecked(i, j) : 0.0;
+    }
+  }
+  return result;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// Householder QR factorization A = Q * R of a rows x cols matrix with
+// rows >= cols. solve() returns the least-squares solution of A x = b,
+// which is the exact one for a square non-singular A; it is better
+// conditioned than the normal equations A^T A x = A^T b.
+class QR {
+
+public:
+
+    // Throws SizeMismatchException if the matrix has more columns than rows.
+    explicit QR(const Matrix& matrix);
+
+    // True if some diagonal element of R is negligible next to the largest
+    // one, within rounding error.
+    bool isRankDeficient() const;
+
+    // The x minimizing |A x - b|, one column per column of b. Throws
+    // SingularMatrixException if isRankDeficient().
+    Matrix solve(const Matrix& b) const;
+    std::vector<double> solve(const std::vector<double>& b) const;
+
+    size_t getRows() const;
+    size_t getCols() const;
+
+    // Thin factors: Q is rows x cols with orthonormal columns, R is
+    // cols x cols upper triangular.
+    Matrix q() const;
+    Matrix r() const;
+
+ private:
+
+    // Reflectors per block of the blocked factorization.
+    static constexpr size_t kPanel = 32;
+
+    void factorize();
+    void factorizePanel(size_t k, size_t width);
+    void applyPanel(size_t k, size_t width);
+    // x <- Q^T x for `cols` columns of x, `ldx` apart, reflector by reflector.
+    void applyTransposedQ(double* x, size_t ldx, size_t cols) const;
+    void substitute(double* x, size_t ldx, size_t cols) const;
+
+    // R on and above the diagonal, the Householder vectors below it
+    // (their leading 1 is implicit).
+    Matrix qr_;
+    std::vector<double> tau_;
+    size_t rows_;
+    size_t cols_;
+
+};
+
+}  // namespace task
@@ -0,0 +1,272 @@
+#include "sparse.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+using namespace task;
+
+namespace {
+
+Matrix zeroMatrix(size_t rows, size_t cols) {
+  Matrix result(rows, cols);
+  std::memset(result.data(), 0, rows * result.getStride() * sizeof(double));
+  return result;
+}
+
+}  // namespace
+
+CooMatrix::CooMatrix(size_t rows, size_t cols) : rows_(rows), cols_(cols) {}
+
+void CooMatrix::add(size_t row, size_t col, double value) {
+  if (row >= rows_ || col >= cols_) {
+    throw OutOfBoundsException();
+  }
+  entries_.push_back(Entry{row, col, value});
+}
+
+void CooMatrix::reserve(size_t entries) {
+  entries_.reserve(entries);
+}
+
+size_t CooMatrix::getRows() const {
+  return rows_;
+}
+
+size_t CooMatrix::getCols() const {
+  return cols_;
+}
+
+size_t CooMatrix::size() const {
+  return entries_.size();
+}
+
+SparseMatrix::SparseMatrix(size_t rows, size_t cols)
+    : rows_(rows), cols_(cols), offsets_(rows + 1, 0) {}
+
+SparseMatrix::SparseMatrix(const CooMatrix& coo)
+    : rows_(coo.rows_), cols_(coo.cols_), offsets_(coo.rows_ + 1, 0) {
+  // Bucket the entries by row (a counting sort), then order every row by
+  // column and fold duplicates into one entry.
+  for (const CooMatrix::Entry& entry : coo.entries_) {
+    ++offsets_[entry.row + 1];
+  }
+  std::partial_sum(offsets_.begin(), offsets_.end(), offsets_.begin());
+
+  std::vector<size_t> order(coo.entries_.size());
+  std::vector<size_t> next(offsets_.begin(), offsets_.end() - 1);
+  for (size_t n = 0; n < coo.entries_.size(); ++n) {
+    order[next[coo.entries_[n].row]++] = n;
+  }
+
+  columns_.reserve(order.size());
+  values_.reserve(order.size());
+  size_t begin = 0;
+  for (size_t i = 0; i < rows_; ++i) {
+    const size_t end = offsets_[i + 1];
+    std::stable_sort(order.begin() + begin, order.begin() + end,
+                     [&coo](size_t a, size_t b) {
+                       return coo.entries_[a].col < coo.entries_[b].col;
+                     });
+    for (size_t n = begin; n < end; ++n) {
+      const CooMatrix::Entry& entry = coo.entries_[order[n]];
+      if (columns_.size() > offsets_[i] && columns_.back() == entry.col) {
+        values_.back() += entry.value;
+      } else {
+        columns_.push_back(entry.col);
+        values_.push_back(entry.value);
+      }
+    }
+    begin = end;
+    offsets_[i + 1] = columns_.size();
+  }
+}
+
+SparseMatrix::SparseMatrix(const Matrix& dense, double tolerance)
+    : rows_(dense.getRows()), cols_(dense.getCols()), offsets_(1, 0) {
+  offsets_.reserve(rows_ + 1);
+  for (size_t i = 0; i < rows_; ++i) {
+    const Matrix::ConstRowView row = dense[i];
+    for (size_t j = 0; j < cols_; ++j) {
+      if (std::fabs(row[j]) > tolerance) {
+        columns_.push_back(j);
+        values_.push_back(row[j]);
+      }
+    }
+    offsets_.push_back(columns_.size());
+  }
+}
+
+SparseMatrix SparseMatrix::identity(size_t size) {
+  SparseMatrix result;
+  result.rows_ = size;
+  result.cols_ = size;
+  result.offsets_.resize(size + 1);
+  std::iota(result.offsets_.begin(), result.offsets_.end(), 0);
+  result.columns_.resize(size);
+  std::iota(result.columns_.begin(), result.columns_.end(), 0);
+  result.values_.assign(size, 1.);
+  return result;
+}
+
+Matrix SparseMatrix::toDense() const {
+  Matrix result = zeroMatrix(rows_, cols_);
+  for (size_t i = 0; i < rows_; ++i) {
+    Matrix::RowView row = result[i];
+    for (size_t n = offsets_[i]; n < offsets_[i + 1]; ++n) {
+      row[columns_[n]] = values_[n];
+    }
+  }
+  return result;
+}
+
+double SparseMatrix::get(size_t row, size_t col) const {
+  checkBounds(row, col);
+  const auto first = columns_.begin() + offsets_[row];
+  const auto last = columns_.begin() + offsets_[row + 1];
+  const auto found = std::lower_bound(first, last, col);
+  if (found == last || *found != col) {
+    return 0.;
+  }
+  return values_[found - columns_.begin()];
+}
+
+std::vector<double> SparseMatrix::operator*(const std::vector<double>& x) const {
+  std::vector<double> y;
+  multiply(x, y);
+  return y;
+}
+
+void SparseMatrix::multiply(const std::vector<double>& x, std::vector<double>& y) const {
+  if (x.size() != cols_) {
+    throw SizeMismatchException();
+  }
+  y.resize(rows_);
+  parallel::forRange(rows_, rowGrain(), [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      double sum = 0.;
+      for (size_t n = offsets_[i]; n < offsets_[i + 1]; ++n) {
+        sum += values_[n] * x[columns_[n]];
+      }
+      y[i] = sum;
+    }
+  });
+}
+
+Matrix SparseMatrix::operator*(const Matrix& dense) const {
+  if (cols_ != dense.getRows()) {
+    throw SizeMismatchException();
+  }
+  const size_t cols = dense.getCols();
+  Matrix result = zeroMatrix(rows_, cols);
+  // Row i of the result is a combination of the rows of `dense` picked by
+  // the non-zeros of row i, so the inner loop runs over contiguous rows.
+  const size_t grain = std::max<size_t>(1, rowGrain() / std::max<size_t>(cols, 1));
+  parallel::forRange(rows_, grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      double* out = result.data() + i * result.getStride();
+      for (size_t n = offsets_[i]; n < offsets_[i + 1]; ++n) {
+        const double factor = values_[n];
+        const double* row = dense.data() + columns_[n] * dense.getStride();
+        for (size_t j = 0; j < cols; ++j) {
+          out[j] += factor * row[j];
+        }
+      }
+    }
+  });
+  return result;
+}
+
+Matrix task::operator*(const Matrix& dense, const SparseMatrix& sparse) {
+  if (dense.getCols() != sparse.getRows()) {
+    throw SizeMismatchException();
+  }
+  const size_t rows = dense.getRows();
+  const size_t inner = dense.getCols();
+  const std::vector<size_t>& offsets = sparse.rowOffsets();
+  const std::vector<size_t>& columns = sparse.columnIndices();
+  const std::vector<double>& values = sparse.values();
+  Matrix result = zeroMatrix(rows, sparse.getCols());
+  const size_t grain = std::max<size_t>(1, parallel::kGrain / std::max<size_t>(inner, 1));
+  parallel::forRange(rows, grain, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      const double* in = dense.data() + i * dense.getStride();
+      double* out = result.data() + i * result.getStride();
+      for (size_t k = 0; k < inner; ++k) {
+        const double factor = in[k];
+        if (factor == 0.) {
+          continue;
+        }
+        for (size_t n = offsets[k]; n < offsets[k + 1]; ++n) {
+          out[columns[n]] += factor * values[n];
+        }
+      }
+    }
+  });
+  return result;
+}
+
+SparseMatrix SparseMatrix::transposed() const {
+  // Counting sort of the entries by column; walking the rows in order keeps
+  // every row of the result sorted.
+  SparseMatrix result;
+  result.rows_ = cols_;
+  result.cols_ = rows_;
+  result.offsets_.assign(cols_ + 1, 0);
+  for (size_t col : columns_) {
+    ++result.offsets_[col + 1];
+  }
+  std::partial_sum(result.offsets_.begin(), result.offsets_.end(),
+                   result.offsets_.begin());
+
+  result.columns_.resize(columns_.size());
+  result.values_.resize(values_.size());
+  std::vector<size_t> next(result.offsets_.begin(), result.offsets_.end() - 1);
+  for (size_t i = 0; i < rows_; ++i) {
+    for (size_t n = offsets_[i]; n < offsets_[i + 1]; ++n) {
+      const size_t position = next[columns_[n]]++;
+      result.columns_[position] = i;
+      result.values_[position] = values_[n];
+    }
+  }
+  return result;
+}
+
+size_t SparseMatrix::getRows() const {
+  return rows_;
+}
+
+size_t SparseMatrix::getCols() const {
+  return cols_;
+}
+
+size_t SparseMatrix::nonZeros() const {
+  return values_.size();
+}
+
+const std::vector<size_t>& SparseMatrix::rowOffsets() const {
+  return offsets_;
+}
+
+const std::vector<size_t>& SparseMatrix::columnIndices() const {
+  return columns_;
+}
+
+const std::vector<double>& SparseMatrix::values() const {
+  return values_;
+}
+
+void SparseMatrix::checkBounds(size_t row, size_t col) const {
+  if (row >= rows_ || col >= cols_) {
+    throw OutOfBoundsException();
+  }
+}
+
+// Rows per parallel chunk, sized by the average number of non-zeros a row
+// holds.
+size_t SparseMatrix::rowGrain() const {
+  const size_t per_row = std::max<size_t>(1, nonZeros() / std::max<size_t>(rows_, 1));
+  return std::max<size_t>(1, parallel::kGrain / per_row);
+}
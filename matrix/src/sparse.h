@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// Coordinate-list (COO) assembly buffer: entries can be added in any order,
+// entries at the same position are summed when a SparseMatrix is built.
+class CooMatrix {
+
+public:
+
+    CooMatrix(size_t rows, size_t cols);
+
+    // Throws OutOfBoundsException for a position outside the matrix.
+    void add(size_t row, size_t col, double value);
+    void reserve(size_t entries);
+
+    size_t getRows() const;
+    size_t getCols() const;
+    size_t size() const;
+
+ private:
+
+    friend class SparseMatrix;
+
+    struct Entry {
+        size_t row;
+        size_t col;
+        double value;
+    };
+
+    size_t rows_;
+    size_t cols_;
+    std::vector<Entry> entries_;
+
+};
+
+
+// Compressed sparse row (CSR) matrix. Row i stores its non-zeros in
+// values()[rowOffsets()[i] .. rowOffsets()[i + 1]), ordered by column.
+// Memory is O(rows + non-zeros), independent of cols.
+class SparseMatrix {
+
+public:
+
+    // All zeros; unlike Matrix(rows, cols) this is not the identity.
+    SparseMatrix(size_t rows, size_t cols);
+    explicit SparseMatrix(const CooMatrix& coo);
+    // Keeps the elements whose absolute value exceeds `tolerance`.
+    explicit SparseMatrix(const Matrix& dense, double tolerance = 0.);
+
+    static SparseMatrix identity(size_t size);
+
+    Matrix toDense() const;
+
+    // Zero for a position that is not stored.
+    double get(size_t row, size_t col) const;
+
+    // Sparse matrix times vector (SpMV), parallel over rows.
+    std::vector<double> operator*(const std::vector<double>& x) const;
+    // The same into y, resized to getRows(); allocates nothing when y
+    // already has that size. x and y must be different vectors.
+    void multiply(const std::vector<double>& x, std::vector<double>& y) const;
+    // Sparse times dense, parallel over rows of the result.
+    Matrix operator*(const Matrix& dense) const;
+
+    SparseMatrix transposed() const;
+
+    size_t getRows() const;
+    size_t getCols() const;
+    size_t nonZeros() const;
+
+    const std::vector<size_t>& rowOffsets() const;
+    const std::vector<size_t>& columnIndices() const;
+    const std::vector<double>& values() const;
+
+ private:
+
+    SparseMatrix() = default;
+
+    void checkBounds(size_t row, size_t col) const;
+    size_t rowGrain() const;
+
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    std::vector<size_t> offsets_;
+    std::vector<size_t> columns_;
+    std::vector<double> values_;
+
+};
+
+// Dense times sparse.
+Matrix operator*(const Matrix& dense, const SparseMatrix& sparse);
+
+}  // namespace task
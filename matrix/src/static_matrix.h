@@ -0,0 +1,378 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+
+// Matrices whose dimensions are known at compile time. Storage lives inside
+// the object, shapes are checked by the type system and every kernel is
+// unrolled over the fixed dimensions. Meant for the 2x2 - 4x4 case where a
+// heap-allocated Matrix costs more than the arithmetic.
+// This header is included at the end of matrix.h.
+
+
+namespace task {
+
+namespace detail {
+
+template <class F, size_t... I>
+constexpr void unrollImpl(F&& f, std::index_sequence<I...>) {
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+// Calls f(integral_constant<size_t, I>) for I = 0 .. N-1, fully unrolled.
+template <size_t N, class F>
+constexpr void unroll(F&& f) {
+    unrollImpl(f, std::make_index_sequence<N>{});
+}
+
+template <class T>
+constexpr T absolute(T value) {
+    return value < T() ? -value : value;
+}
+
+// std::swap is not constexpr before C++20.
+template <class T>
+constexpr void swapValues(T& a, T& b) {
+    T temp = a;
+    a = b;
+    b = temp;
+}
+
+}  // namespace detail
+
+
+template <class T, size_t R, size_t C>
+class StaticMatrix {
+
+    static_assert(R > 0 && C > 0, "StaticMatrix dimensions must be positive");
+
+public:
+
+    using value_type = T;
+
+    // Identity on the main diagonal, zeros elsewhere, as for Matrix.
+    constexpr StaticMatrix() {
+        detail::unroll<(R < C ? R : C)>([&](auto i) { data_[i][i] = T(1); });
+    }
+
+    // Row-major list of all R * C elements.
+    template <class... Args, class = std::enable_if_t<sizeof...(Args) == R * C &&
+                                                      (std::is_arithmetic_v<Args> && ...)>>
+    constexpr explicit StaticMatrix(Args... values) {
+        const T flat[] = {static_cast<T>(values)...};
+        detail::unroll<R * C>([&](auto k) { data_[k / C][k % C] = flat[k]; });
+    }
+
+    // Throws SizeMismatchException if `matrix` is not R x C.
+    explicit StaticMatrix(const BasicMatrix<T>& matrix) {
+        if (matrix.getRows() != R || matrix.getCols() != C) {
+            throw SizeMismatchException();
+        }
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                data_[i][j] = matrix[i][j];
+            }
+        }
+    }
+
+    static constexpr StaticMatrix zeros() {
+        StaticMatrix result;
+        detail::unroll<(R < C ? R : C)>([&](auto i) { result.data_[i][i] = T(); });
+        return result;
+    }
+
+    BasicMatrix<T> toMatrix() const {
+        BasicMatrix<T> result(R, C);
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                result[i][j] = data_[i][j];
+            }
+        }
+        return result;
+    }
+
+    explicit operator BasicMatrix<T>() const { return toMatrix(); }
+
+    static constexpr size_t getRows() { return R; }
+    static constexpr size_t getCols() { return C; }
+
+    T& get(size_t row, size_t col) {
+        checkBounds(row, col);
+        return data_[row][col];
+    }
+    const T& get(size_t row, size_t col) const {
+        checkBounds(row, col);
+        return data_[row][col];
+    }
+    void set(size_t row, size_t col, const T& value) {
+        checkBounds(row, col);
+        data_[row][col] = value;
+    }
+
+    // Unchecked, like Matrix's row views.
+    constexpr T* operator[](size_t row) { return data_[row]; }
+    constexpr const T* operator[](size_t row) const { return data_[row]; }
+    constexpr T& operator()(size_t row, size_t col) { return data_[row][col]; }
+    constexpr const T& operator()(size_t row, size_t col) const { return data_[row][col]; }
+
+    constexpr StaticMatrix& operator+=(const StaticMatrix& a) {
+        detail::unroll<R * C>([&](auto k) { data_[k / C][k % C] += a.data_[k / C][k % C]; });
+        return *this;
+    }
+
+    constexpr StaticMatrix& operator-=(const StaticMatrix& a) {
+        detail::unroll<R * C>([&](auto k) { data_[k / C][k % C] -= a.data_[k / C][k % C]; });
+        return *this;
+    }
+
+    constexpr StaticMatrix& operator*=(const T& number) {
+        detail::unroll<R * C>([&](auto k) { data_[k / C][k % C] *= number; });
+        return *this;
+    }
+
+    constexpr StaticMatrix& operator*=(const StaticMatrix<T, C, C>& a) {
+        return *this = *this * a;
+    }
+
+    constexpr StaticMatrix operator+(const StaticMatrix& a) const {
+        StaticMatrix result = *this;
+        return result += a;
+    }
+
+    constexpr StaticMatrix operator-(const StaticMatrix& a) const {
+        StaticMatrix result = *this;
+        return result -= a;
+    }
+
+    constexpr StaticMatrix operator*(const T& number) const {
+        StaticMatrix result = *this;
+        return result *= number;
+    }
+
+    constexpr StaticMatrix operator-() const {
+        return *this * T(-1);
+    }
+
+    constexpr StaticMatrix operator+() const {
+        return *this;
+    }
+
+    template <size_t K>
+    constexpr StaticMatrix<T, R, K> operator*(const StaticMatrix<T, C, K>& a) const {
+        StaticMatrix<T, R, K> result = StaticMatrix<T, R, K>::zeros();
+        detail::unroll<R>([&](auto i) {
+            detail::unroll<K>([&](auto j) {
+                T sum = T();
+                detail::unroll<C>([&](auto k) { sum += data_[i][k] * a(k, j); });
+                result(i, j) = sum;
+            });
+        });
+        return result;
+    }
+
+    constexpr StaticMatrix<T, C, R> transposed() const {
+        StaticMatrix<T, C, R> result;
+        detail::unroll<R * C>([&](auto k) { result(k % C, k / C) = data_[k / C][k % C]; });
+        return result;
+    }
+
+    constexpr T trace() const {
+        static_assert(R == C, "trace() needs a square matrix");
+        T result = T();
+        detail::unroll<R>([&](auto i) { result += data_[i][i]; });
+        return result;
+    }
+
+    constexpr T det() const {
+        static_assert(R == C, "det() needs a square matrix");
+        const auto& a = data_;
+        if constexpr (R == 1) {
+            return a[0][0];
+        } else if constexpr (R == 2) {
+            return a[0][0] * a[1][1] - a[0][1] * a[1][0];
+        } else if constexpr (R == 3) {
+            return a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+                   a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                   a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+        } else if constexpr (R == 4) {
+            const Minors4 m(a);
+            return m.s0 * m.c5 - m.s1 * m.c4 + m.s2 * m.c3 +
+                   m.s3 * m.c2 - m.s4 * m.c1 + m.s5 * m.c0;
+        } else {
+            return eliminate(nullptr);
+        }
+    }
+
+    // Throws SingularMatrixException when the determinant is zero.
+    constexpr StaticMatrix inverse() const {
+        static_assert(R == C, "inverse() needs a square matrix");
+        const auto& a = data_;
+        StaticMatrix result;
+        if constexpr (R == 1) {
+            const T inv = T(1) / nonZero(a[0][0]);
+            result(0, 0) = inv;
+        } else if constexpr (R == 2) {
+            const T inv = T(1) / nonZero(det());
+            result = StaticMatrix(a[1][1] * inv, -a[0][1] * inv,
+                                  -a[1][0] * inv, a[0][0] * inv);
+        } else if constexpr (R == 3) {
+            const T c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+            const T c01 = a[1][2] * a[2][0] - a[1][0] * a[2][2];
+            const T c02 = a[1][0] * a[2][1] - a[1][1] * a[2][0];
+            const T inv = T(1) / nonZero(a[0][0] * c00 + a[0][1] * c01 + a[0][2] * c02);
+            result = StaticMatrix(
+                c00 * inv,
+                (a[0][2] * a[2][1] - a[0][1] * a[2][2]) * inv,
+                (a[0][1] * a[1][2] - a[0][2] * a[1][1]) * inv,
+                c01 * inv,
+                (a[0][0] * a[2][2] - a[0][2] * a[2][0]) * inv,
+                (a[0][2] * a[1][0] - a[0][0] * a[1][2]) * inv,
+                c02 * inv,
+                (a[0][1] * a[2][0] - a[0][0] * a[2][1]) * inv,
+                (a[0][0] * a[1][1] - a[0][1] * a[1][0]) * inv);
+        } else if constexpr (R == 4) {
+            const Minors4 m(a);
+            const T inv = T(1) / nonZero(m.s0 * m.c5 - m.s1 * m.c4 + m.s2 * m.c3 +
+                                         m.s3 * m.c2 - m.s4 * m.c1 + m.s5 * m.c0);
+            result = StaticMatrix(
+                ( a[1][1] * m.c5 - a[1][2] * m.c4 + a[1][3] * m.c3) * inv,
+                (-a[0][1] * m.c5 + a[0][2] * m.c4 - a[0][3] * m.c3) * inv,
+                ( a[3][1] * m.s5 - a[3][2] * m.s4 + a[3][3] * m.s3) * inv,
+                (-a[2][1] * m.s5 + a[2][2] * m.s4 - a[2][3] * m.s3) * inv,
+                (-a[1][0] * m.c5 + a[1][2] * m.c2 - a[1][3] * m.c1) * inv,
+                ( a[0][0] * m.c5 - a[0][2] * m.c2 + a[0][3] * m.c1) * inv,
+                (-a[3][0] * m.s5 + a[3][2] * m.s2 - a[3][3] * m.s1) * inv,
+                ( a[2][0] * m.s5 - a[2][2] * m.s2 + a[2][3] * m.s1) * inv,
+                ( a[1][0] * m.c4 - a[1][1] * m.c2 + a[1][3] * m.c0) * inv,
+                (-a[0][0] * m.c4 + a[0][1] * m.c2 - a[0][3] * m.c0) * inv,
+                ( a[3][0] * m.s4 - a[3][1] * m.s2 + a[3][3] * m.s0) * inv,
+                (-a[2][0] * m.s4 + a[2][1] * m.s2 - a[2][3] * m.s0) * inv,
+                (-a[1][0] * m.c3 + a[1][1] * m.c1 - a[1][2] * m.c0) * inv,
+                ( a[0][0] * m.c3 - a[0][1] * m.c1 + a[0][2] * m.c0) * inv,
+                (-a[3][0] * m.s3 + a[3][1] * m.s1 - a[3][2] * m.s0) * inv,
+                ( a[2][0] * m.s3 - a[2][1] * m.s1 + a[2][2] * m.s0) * inv);
+        } else {
+            nonZero(eliminate(&result));
+        }
+        return result;
+    }
+
+    bool operator==(const StaticMatrix& a) const {
+        for (size_t i = 0; i < R; ++i) {
+            for (size_t j = 0; j < C; ++j) {
+                if (!ElementTraits<T>::equal(data_[i][j], a.data_[i][j])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const StaticMatrix& a) const {
+        return !(*this == a);
+    }
+
+ private:
+
+    // The 2x2 minors of the top (s) and bottom (c) row pairs of a 4x4
+    // matrix; both its determinant and its adjugate are built from them.
+    struct Minors4 {
+        T s0, s1, s2, s3, s4, s5;
+        T c0, c1, c2, c3, c4, c5;
+
+        constexpr explicit Minors4(const T (&a)[R][C])
+            : s0(a[0][0] * a[1][1] - a[1][0] * a[0][1]),
+              s1(a[0][0] * a[1][2] - a[1][0] * a[0][2]),
+              s2(a[0][0] * a[1][3] - a[1][0] * a[0][3]),
+              s3(a[0][1] * a[1][2] - a[1][1] * a[0][2]),
+              s4(a[0][1] * a[1][3] - a[1][1] * a[0][3]),
+              s5(a[0][2] * a[1][3] - a[1][2] * a[0][3]),
+              c0(a[2][0] * a[3][1] - a[3][0] * a[2][1]),
+              c1(a[2][0] * a[3][2] - a[3][0] * a[2][2]),
+              c2(a[2][0] * a[3][3] - a[3][0] * a[2][3]),
+              c3(a[2][1] * a[3][2] - a[3][1] * a[2][2]),
+              c4(a[2][1] * a[3][3] - a[3][1] * a[2][3]),
+              c5(a[2][2] * a[3][3] - a[3][2] * a[2][3]) {}
+    };
+
+    static constexpr T nonZero(T value) {
+        if (value == T()) {
+            throw SingularMatrixException();
+        }
+        return value;
+    }
+
+    // Gauss-Jordan elimination with partial pivoting for sizes without a
+    // closed form. Returns the determinant; when `inverse` is given (and
+    // starts as the identity) it receives the inverse.
+    constexpr T eliminate(StaticMatrix* inverse) const {
+        StaticMatrix a = *this;
+        T result = T(1);
+        for (size_t k = 0; k < R; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < R; ++i) {
+                if (detail::absolute(a(i, k)) > detail::absolute(a(pivot, k))) {
+                    pivot = i;
+                }
+            }
+            if (a(pivot, k) == T()) {
+                return T();
+            }
+            if (pivot != k) {
+                for (size_t j = 0; j < C; ++j) {
+                    detail::swapValues(a(k, j), a(pivot, j));
+                    if (inverse != nullptr) {
+                        detail::swapValues((*inverse)(k, j), (*inverse)(pivot, j));
+                    }
+                }
+                result = -result;
+            }
+            result *= a(k, k);
+            for (size_t i = 0; i < R; ++i) {
+                if (i == k || (inverse == nullptr && i < k)) {
+                    continue;
+                }
+                const T factor = a(i, k) / a(k, k);
+                for (size_t j = 0; j < C; ++j) {
+                    a(i, j) -= factor * a(k, j);
+                    if (inverse != nullptr) {
+                        (*inverse)(i, j) -= factor * (*inverse)(k, j);
+                    }
+                }
+            }
+        }
+        if (inverse != nullptr) {
+            for (size_t i = 0; i < R; ++i) {
+                const T scale = a(i, i);
+                for (size_t j = 0; j < C; ++j) {
+                    (*inverse)(i, j) /= scale;
+                }
+            }
+        }
+        return result;
+    }
+
+    void checkBounds(size_t row, size_t col) const {
+        if (row >= R || col >= C) {
+            throw OutOfBoundsException();
+        }
+    }
+
+    T data_[R][C] = {};
+
+};
+
+
+template <class T, size_t R, size_t C>
+constexpr StaticMatrix<T, R, C> operator*(const typename StaticMatrix<T, R, C>::value_type& a,
+                                          const StaticMatrix<T, R, C>& b) {
+    return b * a;
+}
+
+template <size_t R, size_t C>
+using StaticMatrixD = StaticMatrix<double, R, C>;
+
+}  // namespace task
@@ -0,0 +1,124 @@
+#include "text_io.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+using namespace task;
+
+namespace {
+
+bool isSpace(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+}  // namespace
+
+TextReader::TextReader(std::istream& input, size_t block_size)
+    : input_(input), buffer_(std::max<size_t>(block_size, 64)), begin_(0), end_(0),
+      exhausted_(false), parsed_(0) {}
+
+size_t TextReader::read(Matrix& matrix) {
+  const size_t rows = readSize();
+  const size_t cols = readSize();
+  if (matrix.getRows() != rows || matrix.getCols() != cols) {
+    matrix = Matrix(rows, cols);
+  }
+  double* data = matrix.data();
+  const size_t stride = matrix.getStride();
+  for (size_t i = 0; i < rows; ++i) {
+    double* row = data + i * stride;
+    for (size_t j = 0; j < cols; ++j) {
+      row[j] = parse<double>();
+    }
+  }
+  parsed_ += rows * cols;
+  return rows * cols;
+}
+
+double TextReader::readDouble() {
+  return parse<double>();
+}
+
+size_t TextReader::readSize() {
+  return parse<size_t>();
+}
+
+size_t TextReader::elementsParsed() const {
+  return parsed_;
+}
+
+template <class T>
+T TextReader::parse() {
+  if (!skipSpace()) {
+    throw FormatException();
+  }
+  // Find the end of the token first: a token that runs into the end of
+  // the block may continue in the next one.
+  size_t token_end = begin_;
+  while (true) {
+    while (token_end < end_ && !isSpace(buffer_[token_end])) {
+      ++token_end;
+    }
+    if (token_end < end_) {
+      break;
+    }
+    const size_t offset = token_end - begin_;
+    if (!refill()) {
+      break;
+    }
+    token_end = begin_ + offset;
+  }
+
+  const char* first = buffer_.data() + begin_;
+  const char* last = buffer_.data() + token_end;
+  if (first != last && *first == '+') {
+    ++first;
+  }
+  T value;
+  const std::from_chars_result result = std::from_chars(first, last, value);
+  if (result.ec != std::errc() || result.ptr != last) {
+    throw FormatException();
+  }
+  begin_ = token_end;
+  return value;
+}
+
+// Skips whitespace. Returns false at the end of the input.
+bool TextReader::skipSpace() {
+  while (true) {
+    while (begin_ < end_ && isSpace(buffer_[begin_])) {
+      ++begin_;
+    }
+    if (begin_ < end_) {
+      return true;
+    }
+    if (!refill()) {
+      return false;
+    }
+  }
+}
+
+// Moves the unparsed tail to the front of the buffer and appends as much of
+// the stream as fits. Returns false when nothing was added.
+bool TextReader::refill() {
+  if (exhausted_) {
+    return false;
+  }
+  std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+  end_ -= begin_;
+  begin_ = 0;
+  if (end_ == buffer_.size()) {
+    // One token fills the whole block.
+    buffer_.resize(buffer_.size() * 2);
+  }
+  const std::streamsize count =
+      input_.rdbuf()->sgetn(buffer_.data() + end_, buffer_.size() - end_);
+  if (count <= 0) {
+    exhausted_ = true;
+    input_.setstate(std::ios::eofbit);
+    return false;
+  }
+  end_ += count;
+  return true;
+}
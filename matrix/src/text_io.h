@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <vector>
+#include "matrix.h"
+
+
+namespace task {
+
+// Bulk reader for the text format of operator>>: "rows cols" followed by
+// rows * cols whitespace-separated numbers. Numbers are parsed with
+// std::from_chars (no locale, no per-element stream calls) straight out of
+// large blocks pulled from the stream buffer.
+//
+// The reader reads ahead, so once it is created the stream must only be
+// consumed through it; numbers outside matrices go through readDouble().
+// Malformed input or a premature end throws FormatException.
+class TextReader {
+
+public:
+
+    static constexpr size_t kBlockSize = 1 << 20;
+
+    explicit TextReader(std::istream& input, size_t block_size = kBlockSize);
+
+    // Reads one matrix in a single pass, reusing its storage when the
+    // shape matches. Returns the number of elements parsed.
+    size_t read(Matrix& matrix);
+    double readDouble();
+    size_t readSize();
+
+    // Elements parsed by read() so far.
+    size_t elementsParsed() const;
+
+ private:
+
+    template <class T>
+    T parse();
+    bool skipSpace();
+    bool refill();
+
+    std::istream& input_;
+    std::vector<char> buffer_;
+    size_t begin_;
+    size_t end_;
+    bool exhausted_;
+    size_t parsed_;
+
+};
+
+}  // namespace task
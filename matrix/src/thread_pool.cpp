@@ -0,0 +1,182 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+using namespace task;
+
+namespace {
+
+thread_local bool inside_task = false;
+
+// Chunks handed out per participant; a few more than one lets stealing
+// even out chunks that run slower than the others.
+const size_t kChunksPerThread = 4;
+
+std::mutex pool_mutex;
+std::shared_ptr<ThreadPool> pool;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) : pending_(0), stop_(false) {
+  threads = std::max<size_t>(threads, 1);
+  for (size_t i = 0; i < threads; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (size_t i = 1; i < threads; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+size_t ThreadPool::size() const {
+  return queues_.size();
+}
+
+bool ThreadPool::insideTask() {
+  return inside_task;
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& body) {
+  if (count == 0) {
+    return;
+  }
+  Job job;
+  job.body = &body;
+  job.remaining = count;
+
+  for (size_t i = 0; i < count; ++i) {
+    Queue& queue = *queues_[i % queues_.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(Task{&job, i});
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    pending_ += count;
+  }
+  wake_.notify_all();
+
+  Task task;
+  while (job.remaining.load() != 0) {
+    if (tryPop(0, task)) {
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.done.wait(lock, [&job] { return job.remaining.load() == 0; });
+  }
+
+  std::lock_guard<std::mutex> lock(job.mutex);
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+bool ThreadPool::tryPop(size_t self, Task& task) {
+  {
+    Queue& own = *queues_[self];
+    std::lock_guard<std::mutex> lock(own.mutex);
+    if (!own.tasks.empty()) {
+      task = own.tasks.front();
+      own.tasks.pop_front();
+      --pending_;
+      return true;
+    }
+  }
+  for (size_t offset = 1; offset < queues_.size(); ++offset) {
+    Queue& victim = *queues_[(self + offset) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = victim.tasks.back();
+      victim.tasks.pop_back();
+      --pending_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::execute(const Task& task) {
+  Job& job = *task.job;
+  const bool was_inside = inside_task;
+  inside_task = true;
+  try {
+    (*job.body)(task.index);
+  } catch (...) {
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (!job.error) {
+      job.error = std::current_exception();
+    }
+  }
+  inside_task = was_inside;
+
+  // The count drops under the lock so that run() cannot see zero, return
+  // and destroy the job while this thread still touches it.
+  std::lock_guard<std::mutex> lock(job.mutex);
+  if (--job.remaining == 0) {
+    job.done.notify_all();
+  }
+}
+
+void ThreadPool::workerLoop(size_t self) {
+  Task task;
+  while (true) {
+    if (tryPop(self, task)) {
+      execute(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stop_ || pending_.load() != 0; });
+    if (stop_) {
+      return;
+    }
+  }
+}
+
+void parallel::setThreadCount(size_t threads) {
+  threads = std::max<size_t>(threads, 1);
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  if (threads == 1) {
+    pool.reset();
+  } else if (!pool || pool->size() != threads) {
+    pool = std::make_shared<ThreadPool>(threads);
+  }
+}
+
+size_t parallel::threadCount() {
+  std::lock_guard<std::mutex> lock(pool_mutex);
+  return pool ? pool->size() : 1;
+}
+
+void parallel::forRange(size_t count, size_t grain,
+                        const std::function<void(size_t, size_t)>& body) {
+  std::shared_ptr<ThreadPool> current;
+  if (count > grain && !ThreadPool::insideTask()) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    current = pool;
+  }
+  if (!current) {
+    if (count != 0) {
+      body(0, count);
+    }
+    return;
+  }
+
+  grain = std::max<size_t>(grain, 1);
+  const size_t chunks = std::min((count + grain - 1) / grain,
+                                 current->size() * kChunksPerThread);
+  const size_t chunk = (count + chunks - 1) / chunks;
+  current->run((count + chunk - 1) / chunk, [&](size_t index) {
+    const size_t begin = index * chunk;
+    body(begin, std::min(begin + chunk, count));
+  });
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace task {
+
+// Fixed-size work-stealing pool. Every participant, including the thread
+// that calls run(), owns a task deque: it takes work from the front of its
+// own deque and steals from the back of the others when it runs dry.
+class ThreadPool {
+
+public:
+
+    // `threads` counts the calling thread too, so ThreadPool(1) spawns none.
+    explicit ThreadPool(size_t threads);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    size_t size() const;
+
+    // Calls body(i) for every i in [0, count) and returns when all calls
+    // are done. The first exception thrown by a call is rethrown here.
+    void run(size_t count, const std::function<void(size_t)>& body);
+
+    // True inside a task; nested parallel loops run serially there.
+    static bool insideTask();
+
+ private:
+
+    struct Job {
+        const std::function<void(size_t)>* body;
+        std::atomic<size_t> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+    };
+
+    struct Task {
+        Job* job;
+        size_t index;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    bool tryPop(size_t self, Task& task);
+    void execute(const Task& task);
+    void workerLoop(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    bool stop_;
+
+};
+
+
+// Process-wide parallel execution policy for the Matrix kernels. Kernels
+// run serially until setThreadCount() is called with more than one thread.
+// Work is split into chunks that write disjoint parts of the result, so the
+// results do not depend on the thread count.
+namespace parallel {
+
+// Rough amount of element-wise work (in elements) worth one chunk.
+const size_t kGrain = 1 << 15;
+
+void setThreadCount(size_t threads);
+size_t threadCount();
+
+// Splits [0, count) into chunks of at least `grain` items and calls
+// body(begin, end) for each chunk, in parallel when enabled.
+void forRange(size_t count, size_t grain,
+              const std::function<void(size_t, size_t)>& body);
+
+}  // namespace parallel
+
+}  // namespace task
@@ -3,8 +3,21 @@
 #include <random>
 #include <algorithm>
 #include <sstream>
+#include <iterator>
 #include <cmath>
+#include <cstring>
 #include "src/matrix.h"
+#include "src/batch.h"
+#include "src/binary_io.h"
+#include "src/cholesky.h"
+#include "src/conjugate_gradient.h"
+#include "src/gemm.h"
+#include "src/lu.h"
+#include "src/pool.h"
+#include "src/qr.h"
+#include "src/sparse.h"
+#include "src/text_io.h"
+#include "src/thread_pool.h"
 
 
 using task::Matrix;
@@ -44,6 +57,139 @@ Matrix RandomMatrix(size_t rows, size_t cols) {
 }
 
 
+// StaticMatrix<N> against the dynamic Matrix code paths.
+template <size_t N>
+bool StaticMatchesDynamic() {
+    auto mat1 = RandomMatrix(N, N);
+    auto mat2 = RandomMatrix(N, N);
+    task::StaticMatrixD<N, N> static1(mat1), static2(mat2);
+
+    return (static1 * static2).toMatrix() == mat1 * mat2 &&
+           (static1 + static2).toMatrix() == mat1 + mat2 &&
+           static1.transposed().toMatrix() == mat1.transposed() &&
+           fabs(static1.det() - mat1.det()) < task::EPS * std::max(1., fabs(mat1.det())) &&
+           static1.inverse().toMatrix() == task::LU(mat1).inverse();
+}
+
+
+// Transfer matrix of domino tilings of a corridor `width` cells wide, built
+// column by column: entry (from, to) counts the ways to finish a column
+// whose cells in `from` are already covered by dominoes from the left, so
+// that the cells in `to` stick out into the next one.
+void FillColumn(size_t width, size_t from, size_t cell, size_t to, task::MatrixMod& transfer) {
+    if (cell == width) {
+        transfer[from][to] += 1;
+        return;
+    }
+    const size_t bit = size_t(1) << cell;
+    if (from & bit) {
+        FillColumn(width, from, cell + 1, to, transfer);
+        return;
+    }
+    FillColumn(width, from, cell + 1, to | bit, transfer);
+    if (cell + 1 < width && !(from & (bit << 1))) {
+        FillColumn(width, from, cell + 2, to, transfer);
+    }
+}
+
+task::MatrixMod CorridorTransfer(size_t width) {
+    const size_t states = size_t(1) << width;
+    task::MatrixMod transfer(states, states);
+    transfer *= task::ModInt(0);
+    for (size_t from = 0; from < states; ++from) {
+        FillColumn(width, from, 0, 0, transfer);
+    }
+    return transfer;
+}
+
+// The same count by the cell-by-cell broken-profile recurrence.
+uint64_t CorridorTilings(size_t width, size_t length) {
+    const uint64_t mod = task::kPrimeModulus;
+    std::vector<uint64_t> ways(size_t(1) << width);
+    ways[0] = 1;
+    for (size_t col = 0; col < length; ++col) {
+        for (size_t cell = 0; cell < width; ++cell) {
+            const size_t bit = size_t(1) << cell;
+            std::vector<uint64_t> next(ways.size());
+            for (size_t mask = 0; mask < ways.size(); ++mask) {
+                if (mask & bit) {
+                    next[mask & ~bit] = (next[mask & ~bit] + ways[mask]) % mod;
+                    continue;
+                }
+                next[mask | bit] = (next[mask | bit] + ways[mask]) % mod;
+                if (cell + 1 < width && !(mask & (bit << 1))) {
+                    next[mask | (bit << 1)] = (next[mask | (bit << 1)] + ways[mask]) % mod;
+                }
+            }
+            ways.swap(next);
+        }
+    }
+    return ways[0];
+}
+
+
+// Largest absolute element.
+double MaxAbs(const Matrix& mat) {
+    double result = 0.;
+    for (size_t i = 0; i < mat.getRows(); ++i) {
+        for (size_t j = 0; j < mat.getCols(); ++j) {
+            result = std::max(result, fabs(mat[i][j]));
+        }
+    }
+    return result;
+}
+
+std::vector<double> RandomVector(size_t size) {
+    std::vector<double> temp(size);
+    for (double& value : temp) {
+        value = RandomDouble();
+    }
+    return temp;
+}
+
+// A vector as a one-column matrix.
+Matrix Column(const std::vector<double>& vector) {
+    Matrix temp(vector.size(), 1);
+    for (size_t i = 0; i < vector.size(); ++i) {
+        temp[i][0] = vector[i];
+    }
+    return temp;
+}
+
+// Symmetric positive definite: B * B^T is semidefinite, the shift makes it
+// definite and keeps it reasonably conditioned.
+Matrix RandomSpd(size_t n) {
+    auto mat = RandomMatrix(n, n);
+    return mat * mat.transposed() + Matrix(n, n) * (100. * n);
+}
+
+// The 5-point Laplacian on a side x side grid, an SPD sparse matrix.
+task::SparseMatrix Laplacian(size_t side) {
+    const size_t n = side * side;
+    task::CooMatrix coo(n, n);
+    for (size_t i = 0; i < n; ++i) {
+        coo.add(i, i, 4.);
+        if (i % side != 0) {
+            coo.add(i, i - 1, -1.);
+            coo.add(i - 1, i, -1.);
+        }
+        if (i >= side) {
+            coo.add(i, i - side, -1.);
+            coo.add(i - side, i, -1.);
+        }
+    }
+    return task::SparseMatrix(coo);
+}
+
+// Reads a string in place, so several streams can parse one copy of it.
+class StringReadBuf : public std::streambuf {
+public:
+    explicit StringReadBuf(std::string& text) {
+        setg(text.data(), text.data(), text.data() + text.size());
+    }
+};
+
+
 void FailWithMsg(const std::string& msg, int line) {
     std::cerr << "Test failed!\n";
     std::cerr << "[Line " << line << "] "  << msg << std::endl;
@@ -208,14 +354,878 @@ int main(int argc, char** argv) {
     }
 
 
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 150), inner = RandomUInt(1, 300), cols = RandomUInt(1, 150);
+        auto mat1 = RandomMatrix(rows, inner);
+        auto mat2 = RandomMatrix(inner, cols);
+        Matrix expected(rows, cols);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                double sum = 0.;
+                for (size_t k = 0; k < inner; ++k) {
+                    sum += mat1.get(i, k) * mat2.get(k, j);
+                }
+                expected.set(i, j, sum);
+            }
+        }
+
+        ASSERT_TRUE_MSG(mat1 * mat2 == expected, "Blocked matrix operator *")
+    }
+
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 100), cols = RandomUInt(1, 100);
+        auto mat1 = RandomMatrix(rows, cols);
+        auto mat2 = RandomMatrix(rows, cols);
+        auto mat3 = RandomMatrix(rows, cols);
+
+        Matrix fused = mat1 + mat2 - mat3 * 2.0;
+        Matrix expected = mat1;
+        expected += mat2;
+        expected -= 2.0 * mat3;
+        ASSERT_TRUE_MSG(fused == expected, "Fused expression")
+
+        fused = -(mat1 - mat2) + mat3;
+        ASSERT_TRUE_MSG(fused == mat2 - mat1 + mat3, "Fused expression")
+
+        auto other = RandomMatrix(rows + 1, cols);
+        ASSERT_EXCEPTION_MSG(mat1 + mat2 - other, task::SizeMismatchException, "Fused expression")
+    }
+
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 300), cols = RandomUInt(1, 300);
+        auto mat1 = RandomMatrix(rows, cols);
+        auto mat2 = mat1.transposed();
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                ASSERT_TRUE_MSG(mat2.get(j, i) == mat1.get(i, j), "Transpose")
+            }
+        }
+        mat2.transpose();
+        ASSERT_TRUE_MSG(mat2 == mat1, "Transpose")
+
+        auto square = RandomMatrix(rows, rows);
+        auto square_t = square;
+        square_t.transpose();
+        ASSERT_TRUE_MSG(square_t == square.transposed(), "In-place transpose")
+
+        Matrix moved = std::move(mat2);
+        ASSERT_TRUE_MSG(moved == mat1 && mat2.getRows() == 0, "Move constructor")
+        mat2 = std::move(moved);
+        ASSERT_TRUE_MSG(mat2 == mat1 && moved.getRows() == 0, "Move operator=")
+
+        auto product = square * square_t;
+        ASSERT_TRUE_MSG(Matrix(square) * square_t == product, "Rvalue operator *")
+        auto sum = mat1 + mat1 * 2.0;
+        ASSERT_TRUE_MSG(Matrix(mat1) + mat1 * 2.0 == sum, "Rvalue operator +")
+        ASSERT_TRUE_MSG(mat1 * 3.0 - Matrix(mat1) == mat1 * 2.0, "Rvalue operator -")
+        ASSERT_TRUE_MSG(-Matrix(mat1) == -mat1, "Rvalue unary -")
+    }
+
+
+    REPEAT(10)
+    {
+        auto n = RandomUInt(1, 60), rhs = RandomUInt(1, 5);
+        auto mat = RandomMatrix(n, n);
+        auto b = RandomMatrix(n, rhs);
+
+        task::LU lu(mat);
+        ASSERT_TRUE_MSG(mat * lu.solve(b) == b, "LU::solve()")
+        ASSERT_TRUE_MSG(mat * lu.inverse() == Matrix(n, n), "LU::inverse()")
+
+        auto upper = RandomMatrix(n, n);
+        double diagonal = 1.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                upper[i][j] = 0.;
+            }
+            upper[i][i] = TossCoin() ? 1.5 : -0.5;
+            diagonal *= upper[i][i];
+        }
+        ASSERT_TRUE_MSG(fabs(upper.det() - diagonal) < EPS * fabs(diagonal), "Determinant")
+
+        for (size_t i = 0; i < n; ++i) {
+            mat[i][0] = 0.;
+        }
+        ASSERT_TRUE_MSG(mat.det() == 0., "Determinant")
+        ASSERT_EXCEPTION_MSG(task::LU(mat).solve(b), task::SingularMatrixException, "LU::solve()")
+    }
+
+
+    {
+        auto mat1 = RandomMatrix(RandomUInt(100, 300), RandomUInt(100, 300));
+        auto mat2 = RandomMatrix(mat1.getCols(), RandomUInt(100, 300));
+        auto product = mat1 * mat2;
+        auto sum = mat1 + mat1 * 2.;
+        auto det = mat2.getCols() == mat2.getRows() ? mat2.det() : 0.;
+
+        task::parallel::setThreadCount(4);
+        ASSERT_TRUE_MSG(task::parallel::threadCount() == 4, "Thread pool")
+        auto parallel_product = mat1 * mat2;
+        Matrix parallel_sum = mat1 + mat1 * 2.;
+        for (size_t i = 0; i < product.getRows(); ++i) {
+            for (size_t j = 0; j < product.getCols(); ++j) {
+                ASSERT_TRUE_MSG(parallel_product[i][j] == product[i][j], "Parallel operator *")
+            }
+        }
+        ASSERT_TRUE_MSG(parallel_sum == sum, "Parallel operator +")
+        ASSERT_TRUE_MSG(mat2.getCols() != mat2.getRows() || mat2.det() == det, "Parallel det()")
+        task::parallel::setThreadCount(1);
+    }
+
+
+    REPEAT(10)
+    {
+        ASSERT_TRUE_MSG(StaticMatchesDynamic<2>(), "StaticMatrix 2x2")
+        ASSERT_TRUE_MSG(StaticMatchesDynamic<3>(), "StaticMatrix 3x3")
+        ASSERT_TRUE_MSG(StaticMatchesDynamic<4>(), "StaticMatrix 4x4")
+        ASSERT_TRUE_MSG(StaticMatchesDynamic<5>(), "StaticMatrix 5x5")
+
+        constexpr task::StaticMatrixD<2, 2> constant(1., 2., 3., 4.);
+        static_assert(constant.det() == -2., "constexpr StaticMatrix::det()");
+        static_assert((constant * constant)(1, 0) == 15., "constexpr StaticMatrix operator *");
+
+        using Static23 = task::StaticMatrixD<2, 3>;
+        using Static33 = task::StaticMatrixD<3, 3>;
+        ASSERT_EXCEPTION_MSG(Static23(RandomMatrix(3, 2)), task::SizeMismatchException,
+                             "StaticMatrix from Matrix")
+        ASSERT_EXCEPTION_MSG(Static33::zeros().inverse(), task::SingularMatrixException,
+                             "StaticMatrix::inverse()")
+        ASSERT_EXCEPTION_MSG(constant.get(2, 0), task::OutOfBoundsException, "StaticMatrix::get()")
+    }
+
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 120), cols = RandomUInt(1, 120), other = RandomUInt(1, 50);
+        Matrix dense(rows, cols);
+        task::CooMatrix coo(rows, cols);
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                dense[i][j] = 0.;
+            }
+        }
+        for (size_t n = RandomUInt(0, rows * cols / 10); n > 0; --n) {
+            auto i = RandomUInt(0, rows - 1), j = RandomUInt(0, cols - 1);
+            auto value = RandomDouble();
+            dense[i][j] += value;
+            coo.add(i, j, value);
+        }
+        task::SparseMatrix sparse(coo);
+        std::vector<double> x(cols);
+        Matrix column(cols, 1);
+        for (size_t j = 0; j < cols; ++j) {
+            x[j] = column[j][0] = RandomDouble();
+        }
+        auto y = sparse * x;
+        auto expected = dense * column;
+        bool spmv_ok = y.size() == rows;
+        for (size_t i = 0; spmv_ok && i < rows; ++i) {
+            spmv_ok = fabs(y[i] - expected[i][0]) < EPS;
+        }
+        std::vector<double> into(rows, 1.);
+        sparse.multiply(x, into);
+        auto right = RandomMatrix(cols, other);
+        auto left = RandomMatrix(other, rows);
+
+        ASSERT_TRUE_MSG(sparse.toDense() == dense, "SparseMatrix from CooMatrix")
+        ASSERT_TRUE_MSG(task::SparseMatrix(dense).toDense() == dense, "SparseMatrix from Matrix")
+        ASSERT_TRUE_MSG(task::SparseMatrix(dense).nonZeros() <= coo.size(), "SparseMatrix::nonZeros()")
+        ASSERT_TRUE_MSG(spmv_ok, "SparseMatrix SpMV")
+        ASSERT_TRUE_MSG(into == y, "SparseMatrix::multiply()")
+        ASSERT_EXCEPTION_MSG(sparse.multiply(std::vector<double>(cols + 1), into), task::SizeMismatchException, "SparseMatrix::multiply()")
+        ASSERT_TRUE_MSG(sparse * right == dense * right, "SparseMatrix * Matrix")
+        ASSERT_TRUE_MSG(left * sparse == left * dense, "Matrix * SparseMatrix")
+        ASSERT_TRUE_MSG(sparse.transposed().toDense() == dense.transposed(), "SparseMatrix::transposed()")
+        ASSERT_TRUE_MSG(task::SparseMatrix::identity(rows) * dense == dense, "SparseMatrix::identity()")
+        ASSERT_TRUE_MSG(sparse.get(rows - 1, cols - 1) == dense[rows - 1][cols - 1], "SparseMatrix::get()")
+        ASSERT_EXCEPTION_MSG(sparse.get(rows, 0), task::OutOfBoundsException, "SparseMatrix::get()")
+        ASSERT_EXCEPTION_MSG(coo.add(0, cols, 1.), task::OutOfBoundsException, "CooMatrix::add()")
+        ASSERT_EXCEPTION_MSG(sparse * Matrix(cols + 1, 1), task::SizeMismatchException, "SparseMatrix * Matrix")
+    }
+
+
+    REPEAT(5)
+    {
+        const std::string path = "matrix_test.bin";
+        auto rows = RandomUInt(1, 200), cols = RandomUInt(1, 200);
+        auto mat = RandomMatrix(rows, cols);
+        mat.save(path);
+
+        auto loaded = Matrix::load(path);
+        auto mapped = Matrix::mmap(path);
+        ASSERT_TRUE_MSG(loaded.getRows() == rows && loaded.getCols() == cols, "Matrix::load()")
+        ASSERT_TRUE_MSG(std::equal(mat.data(), mat.data() + rows * mat.getStride(), loaded.data()),
+                        "Matrix::load()")
+        ASSERT_TRUE_MSG(mapped.isMapped() && !loaded.isMapped(), "Matrix::mmap()")
+        ASSERT_TRUE_MSG(mapped == mat, "Matrix::mmap()")
+        mapped[0][0] += 1.;
+        ASSERT_TRUE_MSG(Matrix::load(path) == mat, "Matrix::mmap() is copy-on-write")
+        mapped.resize(rows + 1, cols);
+        ASSERT_TRUE_MSG(!mapped.isMapped() && mapped[rows][0] == 0., "Matrix::mmap() resize()")
+
+        {
+            task::MatrixWriter writer(path, rows, cols);
+            for (size_t i = 0; i < rows; ++i) {
+                writer.writeRow(mat[i].data());
+            }
+            ASSERT_EXCEPTION_MSG(writer.writeRow(mat[0].data()), task::OutOfBoundsException,
+                                 "MatrixWriter::writeRow()")
+            writer.close();
+        }
+        ASSERT_TRUE_MSG(Matrix::load(path) == mat, "MatrixWriter")
+        ASSERT_EXCEPTION_MSG(task::MatrixWriter(path, rows + 1, cols).close(), task::IOException,
+                             "MatrixWriter::close()")
+
+        task::binary::FileHeader header = {};
+        std::memcpy(header.magic, task::binary::kMagic, sizeof(header.magic));
+        header.version = task::binary::kVersion;
+        header.dtype = task::binary::DType<double>::kCode;
+        header.byte_order = task::binary::kByteOrderMark;
+        header.header_size = sizeof(header);
+        header.rows = ~uint64_t(0);
+        std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(&header), sizeof(header));
+        loaded = Matrix::load(path);
+        mapped = Matrix::mmap(path);
+        ASSERT_TRUE_MSG(loaded.getRows() == 0 && loaded.getCols() == 0, "Matrix::load() of rows without columns")
+        ASSERT_TRUE_MSG(mapped.getRows() == 0 && mapped.getCols() == 0, "Matrix::mmap() of rows without columns")
+        Matrix(rows, 0).save(path);
+        ASSERT_TRUE_MSG(Matrix::load(path).getRows() == 0, "Matrix::load() of rows without columns")
+
+        std::ofstream(path) << "100 50\n";
+        ASSERT_EXCEPTION_MSG(Matrix::load(path), task::FormatException, "Matrix::load()")
+        ASSERT_EXCEPTION_MSG(Matrix::mmap(path), task::FormatException, "Matrix::mmap()")
+        std::remove(path.c_str());
+        ASSERT_EXCEPTION_MSG(Matrix::load(path), task::IOException, "Matrix::load()")
+    }
+
+
+    REPEAT(10)
+    {
+        auto mat1 = RandomMatrix(RandomUInt(1, 100), RandomUInt(1, 100));
+        auto mat2 = RandomMatrix(RandomUInt(1, 100), RandomUInt(1, 100));
+        Matrix read1, read2;
+
+        std::stringstream stream;
+        stream.precision(10);
+        stream << mat1.getRows() << ' ' << mat1.getCols() << '\n' << mat1;
+        stream << "-2.5\n" << mat2.getRows() << ' ' << mat2.getCols() << '\n' << mat2;
+
+        // A tiny block makes numbers straddle block boundaries.
+        task::TextReader reader(stream, RandomUInt(1, 100));
+        ASSERT_TRUE_MSG(reader.read(read1) == mat1.getRows() * mat1.getCols(), "TextReader::read()")
+        ASSERT_TRUE_MSG(reader.readDouble() == -2.5, "TextReader::readDouble()")
+        reader.read(read2);
+        ASSERT_TRUE_MSG(read1 == mat1 && read2 == mat2, "TextReader::read()")
+        ASSERT_TRUE_MSG(reader.elementsParsed() == mat1.getRows() * mat1.getCols() +
+                        mat2.getRows() * mat2.getCols(), "TextReader::elementsParsed()")
+        ASSERT_EXCEPTION_MSG(reader.readDouble(), task::FormatException, "TextReader end of input")
+
+        std::stringstream bad("2 2\n1 2 x 4\n");
+        task::TextReader bad_reader(bad);
+        ASSERT_EXCEPTION_MSG(bad_reader.read(read1), task::FormatException, "TextReader bad number")
+    }
+
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(1, 80), inner = RandomUInt(1, 80), cols = RandomUInt(1, 80);
+        auto mat1 = RandomMatrix(rows, inner);
+        auto mat2 = RandomMatrix(inner, cols);
+        auto product = mat1 * mat2;
+
+        task::MatrixF float1(rows, inner), float2(inner, cols);
+        task::MatrixI64 int1(rows, inner), int2(inner, cols);
+        task::MatrixC complex1(rows, inner), complex2(inner, cols);
+        for (size_t i = 0; i < inner; ++i) {
+            for (size_t j = 0; j < rows; ++j) {
+                float1[j][i] = static_cast<float>(mat1[j][i]);
+                int1[j][i] = static_cast<int64_t>(mat1[j][i]);
+                complex1[j][i] = {mat1[j][i], 0.};
+            }
+            for (size_t j = 0; j < cols; ++j) {
+                float2[i][j] = static_cast<float>(mat2[i][j]);
+                int2[i][j] = static_cast<int64_t>(mat2[i][j]);
+                complex2[i][j] = {0., mat2[i][j]};
+            }
+        }
+
+        auto float_product = float1 * float2;
+        auto int_product = int1 * int2;
+        auto complex_product = complex1 * complex2;
+        bool float_ok = true, int_ok = true, complex_ok = true;
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                int64_t expected = 0;
+                for (size_t k = 0; k < inner; ++k) {
+                    expected += int1[i][k] * int2[k][j];
+                }
+                float_ok = float_ok && fabs(float_product[i][j] - product[i][j]) <
+                                           1e-5 * (1. + fabs(product[i][j])) * inner;
+                int_ok = int_ok && int_product[i][j] == expected;
+                complex_ok = complex_ok && fabs(complex_product[i][j].real()) < EPS &&
+                                           fabs(complex_product[i][j].imag() - product[i][j]) < EPS;
+            }
+        }
+        ASSERT_TRUE_MSG(float_ok, "MatrixF operator *")
+        ASSERT_TRUE_MSG(int_ok, "MatrixI64 operator *")
+        ASSERT_TRUE_MSG(complex_ok, "MatrixC operator *")
+        ASSERT_TRUE_MSG(float1 + float1 * 2.f == float1 * 3.f, "MatrixF fused expression")
+        ASSERT_TRUE_MSG(-int1 + int1 * 3 == int1 * 2, "MatrixI64 fused expression")
+
+        auto exact = int1;
+        exact[0][0] += 1;
+        ASSERT_TRUE_MSG(exact != int1, "MatrixI64 exact operator ==")
+        auto close = float1;
+        close[0][0] += 5e-4f;
+        ASSERT_TRUE_MSG(close == float1, "MatrixF operator ==")
+        close[0][0] += 2e-3f;
+        ASSERT_TRUE_MSG(close != float1, "MatrixF operator ==")
+
+        // L * U with a unit lower L has the determinant of U, exactly.
+        auto n = RandomUInt(1, 8);
+        task::MatrixI64 lower(n, n), upper(n, n);
+        int64_t diagonal = 1;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                lower[i][j] = static_cast<int64_t>(RandomUInt(0, 6)) - 3;
+                upper[j][i] = static_cast<int64_t>(RandomUInt(0, 6)) - 3;
+            }
+            upper[i][i] = TossCoin() ? 2 : -1;
+            diagonal *= upper[i][i];
+        }
+        auto square = RandomMatrix(n, n);
+        task::MatrixF float_square(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                float_square[i][j] = static_cast<float>(square[i][j]);
+            }
+        }
+        ASSERT_TRUE_MSG((lower * upper).det() == diagonal, "MatrixI64 det()")
+        ASSERT_TRUE_MSG(fabs(float_square.det() - square.det()) < 1e-3 * (1. + fabs(square.det())),
+                        "MatrixF det()")
+        ASSERT_TRUE_MSG(Matrix(0, 0).det() == 1. && task::MatrixF(0, 0).det() == 1.f &&
+                        task::MatrixI64(0, 0).det() == 1 &&
+                        task::MatrixC(0, 0).det() == std::complex<double>(1.) &&
+                        task::MatrixMod(0, 0).det() == task::ModInt(1), "det() of a 0x0 matrix")
+
+        const std::string path = "matrix_test.bin";
+        float1.save(path);
+        ASSERT_TRUE_MSG(task::MatrixF::load(path) == float1, "MatrixF::load()")
+        ASSERT_EXCEPTION_MSG(Matrix::load(path), task::FormatException, "Matrix::load() dtype")
+        std::remove(path.c_str());
+    }
+
+
+    REPEAT(10)
+    {
+        auto rows = RandomUInt(2, 80), cols = RandomUInt(2, 80);
+        auto mat = RandomMatrix(rows, cols);
+        auto other = RandomMatrix(rows, cols);
+        auto row = RandomUInt(0, rows - 1), col = RandomUInt(0, cols - 1);
+        auto height = RandomUInt(1, rows - row), width = RandomUInt(1, cols - col);
+        const Matrix& constant = mat;
+
+        Matrix block(height, width), other_block(height, width);
+        for (size_t i = 0; i < height; ++i) {
+            for (size_t j = 0; j < width; ++j) {
+                block[i][j] = mat[row + i][col + j];
+                other_block[i][j] = other[row + i][col + j];
+            }
+        }
+        Matrix column(rows, 1);
+        Matrix diagonal(std::min(rows, cols), 1);
+        for (size_t i = 0; i < rows; ++i) {
+            column[i][0] = mat[i][col];
+            if (i < cols) {
+                diagonal[i][0] = mat[i][i];
+            }
+        }
+        auto mat_row = mat.getRow(row);
+        auto mat_column = mat.getColumn(col);
+        bool vectors_ok = mat_row.size() == cols && mat_column.size() == rows;
+        for (size_t j = 0; vectors_ok && j < cols; ++j) {
+            vectors_ok = mat_row[j] == mat[row][j];
+        }
+        for (size_t i = 0; vectors_ok && i < rows; ++i) {
+            vectors_ok = mat_column[i] == mat[i][col];
+        }
+
+        task::ConstMatrixView view = constant.block(row, col, height, width);
+        ASSERT_TRUE_MSG(Matrix(view) == block, "Matrix::block()")
+        ASSERT_TRUE_MSG(view.get(height - 1, width - 1) == block[height - 1][width - 1], "MatrixView::get()")
+        ASSERT_TRUE_MSG(Matrix(mat.columnView(col)) == column, "Matrix::columnView()")
+        ASSERT_TRUE_MSG(Matrix(mat.rowView(row)) == Matrix(mat.rowView(row).transposed().transposed()),
+                        "MatrixView::transposed()")
+        ASSERT_TRUE_MSG(Matrix(mat.diagonalView()) == diagonal, "Matrix::diagonalView()")
+        ASSERT_TRUE_MSG(vectors_ok, "Matrix::getRow(), Matrix::getColumn()")
+        ASSERT_TRUE_MSG(view + other.block(row, col, height, width) * 2. == block + other_block * 2.,
+                        "MatrixView expressions")
+        ASSERT_TRUE_MSG(view.transposed() * view == block.transposed() * block, "MatrixView operator *")
+        ASSERT_TRUE_MSG(view * other_block.transposed() == block * other_block.transposed(),
+                        "MatrixView operator *")
+        ASSERT_TRUE_MSG(mat.block(0, col, rows, width) * (view.transposed() + view.transposed()) ==
+                        Matrix(mat.block(0, col, rows, width)) * (block.transposed() * 2.),
+                        "MatrixView operator *")
+
+        auto copy = mat;
+        copy.block(row, col, height, width) = other_block;
+        copy.block(row, col, height, width) += other.block(row, col, height, width);
+        copy.block(row, col, height, width) *= 0.5;
+        bool assigned_ok = true;
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                bool inside = i >= row && i < row + height && j >= col && j < col + width;
+                assigned_ok = assigned_ok && fabs(copy[i][j] - (inside ? other[i][j] : mat[i][j])) < EPS;
+            }
+        }
+        ASSERT_TRUE_MSG(assigned_ok, "MatrixView assignment")
+
+        // Assigning a view of the destination itself: a resize would free
+        // what the view reads, a transpose would overwrite it.
+        auto shrunk = mat;
+        shrunk = shrunk.block(row, col, height, width);
+        ASSERT_TRUE_MSG(shrunk == block, "Matrix = view of itself")
+        Matrix square = RandomMatrix(cols, cols);
+        const Matrix square_transposed = square.transposed();
+        square = square.view().transposed();
+        ASSERT_TRUE_MSG(square == square_transposed, "Matrix = transposed view of itself")
+        square += square.view().transposed() * 2.;
+        ASSERT_TRUE_MSG(square == square_transposed + square_transposed.transposed() * 2.,
+                        "Matrix += transposed view of itself")
+
+        ASSERT_EXCEPTION_MSG(mat.block(row, col, height, width + cols), task::OutOfBoundsException,
+                             "Matrix::block()")
+        ASSERT_EXCEPTION_MSG(mat.rowView(rows), task::OutOfBoundsException, "Matrix::rowView()")
+        ASSERT_EXCEPTION_MSG(view.get(height, 0), task::OutOfBoundsException, "MatrixView::get()")
+        ASSERT_EXCEPTION_MSG(copy.block(0, 0, rows, cols) = view.transposed().transposed() * 1.,
+                             task::SizeMismatchException, "MatrixView assignment")
+        ASSERT_EXCEPTION_MSG(view * Matrix(width + 1, 1), task::SizeMismatchException, "MatrixView operator *")
+    }
+
+
+    {
+        // Large enough to run through several panels of the blocked LU.
+        auto n = RandomUInt(150, 300);
+        auto mat = RandomMatrix(n, n);
+        auto b = RandomMatrix(n, 3);
+        auto residual = mat * task::LU(mat).solve(b) - b;
+        double error = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                error = std::max(error, fabs(residual[i][j]));
+            }
+        }
+        ASSERT_TRUE_MSG(error < 1e-8, "Blocked LU::solve()")
+    }
+
+
+    {
+        auto rows = RandomUInt(1, 20), cols = RandomUInt(1, 20);
+        auto mat = RandomMatrix(rows, cols);
+        const Matrix& constant = mat;
+        bool access_ok = true;
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                access_ok = access_ok && &mat(i, j) == &mat[i][j] && constant(i, j) == mat.get(i, j) &&
+                            &constant.unchecked(i, j) == &mat(i, j);
+            }
+        }
+        mat(rows - 1, cols - 1) = 42.;
+        ASSERT_TRUE_MSG(access_ok && mat.get(rows - 1, cols - 1) == 42., "operator()")
+        ASSERT_EXCEPTION_MSG(mat(rows, 0), task::OutOfBoundsException, "Checked operator()")
+        ASSERT_EXCEPTION_MSG(constant(0, cols), task::OutOfBoundsException, "Checked operator()")
+        ASSERT_EXCEPTION_MSG(mat[rows], task::OutOfBoundsException, "Checked operator[]")
+    }
+
+
+    REPEAT(10)
+    {
+        // Sizes up to 4 take the vectorized closed forms, larger ones LU.
+        auto n = RandomUInt(1, 6), count = RandomUInt(1, 40);
+        task::MatrixBatch batch1(count, n, n), batch2(count, n, n);
+        std::vector<Matrix> mats1, mats2;
+        for (size_t i = 0; i < count; ++i) {
+            mats1.push_back(RandomMatrix(n, n));
+            mats2.push_back(RandomMatrix(n, n));
+            batch1.setMatrix(i, mats1.back());
+            batch2.setMatrix(i, mats2.back());
+        }
+
+        auto product = batch1 * batch2;
+        auto transposed = batch1.transposed();
+        auto det = batch1.det();
+        auto inverse = batch1.inverse();
+        task::MatrixBatch reused(1, 7, 7);
+        batch2.inverse(reused);
+        bool batch_ok = det.size() == count && product.size() == count;
+        for (size_t i = 0; batch_ok && i < count; ++i) {
+            batch_ok = batch1.getMatrix(i) == mats1[i] &&
+                       batch1(i, n - 1, 0) == mats1[i][n - 1][0] &&
+                       product.getMatrix(i) == mats1[i] * mats2[i] &&
+                       transposed.getMatrix(i) == mats1[i].transposed() &&
+                       fabs(det[i] - mats1[i].det()) < task::EPS * std::max(1., fabs(det[i])) &&
+                       inverse.getMatrix(i) == task::LU(mats1[i]).inverse() &&
+                       reused.getMatrix(i) == task::LU(mats2[i]).inverse();
+        }
+        ASSERT_TRUE_MSG(batch_ok, "MatrixBatch")
+
+        task::MatrixBatch wide(count, n, n + 1);
+        wide.setMatrix(count - 1, RandomMatrix(n, n + 1));
+        ASSERT_TRUE_MSG((batch1 * wide).getMatrix(count - 1) == mats1[count - 1] * wide.getMatrix(count - 1),
+                        "MatrixBatch operator * rectangular")
+        ASSERT_TRUE_MSG(wide.transposed().getMatrix(count - 1) == wide.getMatrix(count - 1).transposed(),
+                        "MatrixBatch::transposed() rectangular")
+
+        batch1.setMatrix(count - 1, Matrix(n, n) * 0.);
+        ASSERT_EXCEPTION_MSG(batch1.inverse(), task::SingularMatrixException, "MatrixBatch::inverse()")
+        ASSERT_EXCEPTION_MSG(wide * batch1, task::SizeMismatchException, "MatrixBatch operator *")
+        ASSERT_EXCEPTION_MSG(wide.det(), task::SizeMismatchException, "MatrixBatch::det()")
+        ASSERT_EXCEPTION_MSG(batch1.setMatrix(0, Matrix(n + 1, n)), task::SizeMismatchException,
+                             "MatrixBatch::setMatrix()")
+        ASSERT_EXCEPTION_MSG(batch1.getMatrix(count), task::OutOfBoundsException, "MatrixBatch::getMatrix()")
+    }
+
+    {
+        // Enough matrices for every worker to get chunks of its own.
+        const size_t count = 100000;
+        task::MatrixBatch batch(count, 3, 3);
+        for (size_t i = 0; i < count; ++i) {
+            batch.setMatrix(i, RandomMatrix(3, 3));
+        }
+        task::parallel::setThreadCount(4);
+        const auto inverse = batch.inverse();
+        const bool inverse_ok = inverse.getMatrix(count - 1) == task::LU(batch.getMatrix(count - 1)).inverse();
+        batch.setMatrix(count - 1, Matrix(3, 3) * 0.);
+        // Repeated: on a single core the calling thread may well take all
+        // the chunks itself.
+        bool singular_thrown = true;
+        for (size_t repeat = 0; repeat < 10; ++repeat) {
+            try {
+                batch.inverse();
+                singular_thrown = false;
+            } catch (const task::SingularMatrixException&) {
+            }
+        }
+        task::parallel::setThreadCount(1);
+        ASSERT_TRUE_MSG(inverse_ok, "Parallel MatrixBatch::inverse()")
+        ASSERT_TRUE_MSG(singular_thrown, "Parallel MatrixBatch::inverse() singular")
+    }
+
+
+    REPEAT(5)
+    {
+        // A small cutoff recurses several levels, peeling odd orders.
+        auto n = RandomUInt(40, 150);
+        const size_t cutoff = 16;
+        task::MatrixF float1(n, n), float2(n, n), classic(n, n), strassen(n, n);
+        Matrix exact1(n, n), exact2(n, n);
+        task::MatrixI64 int1(n, n), int2(n, n), int_classic(n, n), int_strassen(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                exact1[i][j] = float1[i][j] = static_cast<float>(RandomDouble());
+                exact2[i][j] = float2[i][j] = static_cast<float>(RandomDouble());
+                classic[i][j] = strassen[i][j] = 0.f;
+                int1[i][j] = static_cast<int64_t>(RandomUInt(0, 200)) - 100;
+                int2[i][j] = static_cast<int64_t>(RandomUInt(0, 200)) - 100;
+                int_classic[i][j] = int_strassen[i][j] = 0;
+            }
+        }
+        task::gemm::multiply(n, n, n, float1.data(), float1.getStride(), float2.data(),
+                             float2.getStride(), classic.data(), classic.getStride());
+        task::gemm::strassen(n, float1.data(), float1.getStride(), float2.data(),
+                             float2.getStride(), strassen.data(), strassen.getStride(), cutoff);
+        task::gemm::multiply(n, n, n, int1.data(), int1.getStride(), int2.data(),
+                             int2.getStride(), int_classic.data(), int_classic.getStride());
+        task::gemm::strassen(n, int1.data(), int1.getStride(), int2.data(),
+                             int2.getStride(), int_strassen.data(), int_strassen.getStride(), cutoff);
+
+        // Single precision against the product of the same values in double.
+        auto exact = exact1 * exact2;
+        double classic_error = 0., strassen_error = 0.;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                classic_error = std::max(classic_error, fabs(classic[i][j] - exact[i][j]));
+                strassen_error = std::max(strassen_error, fabs(strassen[i][j] - exact[i][j]));
+            }
+        }
+        ASSERT_TRUE_MSG(strassen_error < 100. * classic_error, "gemm::strassen() float error")
+        ASSERT_TRUE_MSG(int_strassen == int_classic, "gemm::strassen() exact on MatrixI64")
+        Matrix product(n, n);
+        product *= 0.;
+        task::gemm::strassen(n, exact1.data(), exact1.getStride(), exact2.data(),
+                             exact2.getStride(), product.data(), product.getStride(), cutoff);
+        ASSERT_TRUE_MSG(product == exact, "gemm::strassen()")
+    }
+
+
+    REPEAT(10)
+    {
+        auto n = RandomUInt(1, 30), k = RandomUInt(0, 20);
+        auto mat = RandomMatrix(n, n) * (0.1 / n);
+        Matrix expected(n, n);
+        task::MatrixI64 int_mat(n, n), int_expected(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                int_mat[i][j] = static_cast<int64_t>(RandomUInt(0, 4)) - 2;
+            }
+        }
+        for (size_t i = 0; i < k; ++i) {
+            expected = expected * mat;
+            if (i < 6) {
+                int_expected = int_expected * int_mat;
+            }
+        }
+        ASSERT_TRUE_MSG(mat.pow(k) == expected, "Matrix::pow()")
+        ASSERT_TRUE_MSG(int_mat.pow(std::min<size_t>(k, 6)) == int_expected, "MatrixI64::pow()")
+        ASSERT_EXCEPTION_MSG(RandomMatrix(n, n + 1).pow(2), task::SizeMismatchException, "Matrix::pow()")
+
+        task::MatrixMod mod1(n, n), mod2(n, n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                mod1[i][j] = task::ModInt(int_mat[i][j]);
+                mod2[i][j] = task::ModInt(static_cast<int64_t>(RandomUInt(0, task::kPrimeModulus - 1)));
+            }
+        }
+        // Past 12 x 12 the minors Bareiss goes through may overflow int64.
+        ASSERT_TRUE_MSG(n > 12 || mod1.det() == task::ModInt(int_mat.det()), "MatrixMod det() against MatrixI64")
+        ASSERT_TRUE_MSG((mod1 * mod2).det() == mod1.det() * mod2.det(), "MatrixMod det() of a product")
+        ASSERT_TRUE_MSG(mod2.pow(k + 3) == mod2.pow(k) * mod2 * mod2 * mod2, "MatrixMod::pow()")
+        for (size_t j = 0; j < n; ++j) {
+            mod2[n - 1][j] = mod2[0][j] * task::ModInt(3);
+        }
+        ASSERT_TRUE_MSG(n == 1 || mod2.det() == task::ModInt(0), "MatrixMod det() of a singular matrix")
+    }
+
+
+    {
+        // Domino tilings of an N x M corridor narrower than six, modulo
+        // 1e9 + 7, as in the second variant of hw_7.
+        ASSERT_TRUE_MSG(CorridorTransfer(2).pow(10)[0][0] == task::ModInt(89), "Corridor 2 x 10")
+        ASSERT_TRUE_MSG(CorridorTransfer(4).pow(4)[0][0] == task::ModInt(36), "Corridor 4 x 4")
+        ASSERT_TRUE_MSG(CorridorTransfer(5).pow(6)[0][0] == task::ModInt(1183), "Corridor 5 x 6")
+        ASSERT_TRUE_MSG(CorridorTransfer(3).pow(5)[0][0] == task::ModInt(0), "Corridor 3 x 5")
+        for (size_t width = 1; width < 6; ++width) {
+            auto length = RandomUInt(1, 99);
+            ASSERT_TRUE_MSG(CorridorTransfer(width).pow(length)[0][0] ==
+                            task::ModInt(static_cast<int64_t>(CorridorTilings(width, length))),
+                            "Corridor tilings modulo 1e9 + 7")
+        }
+    }
+
+
+    {
+        using task::profile::Operation;
+        task::profile::reset();
+        auto mat1 = RandomMatrix(20, 30), mat2 = RandomMatrix(30, 10);
+        Matrix product = mat1 * mat2;
+        Matrix sum = product + product * 2.;
+        sum.transpose();
+        mat1.resize(30, 30);
+        mat1.det();
+        const auto products = task::profile::counters(Operation::kProduct);
+        const auto elementwise = task::profile::counters(Operation::kElementwise);
+        const auto transposes = task::profile::counters(Operation::kTranspose);
+        std::ostringstream json;
+        task::profile::report(json, true);
+        if (task::profile::kEnabled) {
+            ASSERT_TRUE_MSG(products.calls == 1 && products.flops == 2 * 20 * 30 * 10 &&
+                            products.bytes == 20 * product.getStride() * sizeof(double),
+                            "Profiled product")
+            ASSERT_TRUE_MSG(elementwise.calls == 1 && elementwise.flops == 2 * 20 * 10,
+                            "Profiled expression")
+            // transpose() of a non-square matrix goes through transposed().
+            ASSERT_TRUE_MSG(transposes.calls == 1, "Profiled nested operations")
+            ASSERT_TRUE_MSG(task::profile::counters(Operation::kDet).calls == 1 &&
+                            task::profile::counters(Operation::kResize).calls == 1, "Profiled det(), resize()")
+            ASSERT_TRUE_MSG(json.str().find("\"name\": \"product\", \"calls\": 1") != std::string::npos,
+                            "Profile JSON report")
+        } else {
+            ASSERT_TRUE_MSG(products.calls == 0 && products.bytes == 0 && elementwise.calls == 0 &&
+                            json.str() == "{\"operations\": []}\n", "Profiling compiled out")
+        }
+    }
+
+
+    {
+        // Sizes past one panel of the blocked Cholesky and QR.
+        auto n = RandomUInt(1, 200), rhs = RandomUInt(1, 5);
+        auto mat = RandomSpd(n);
+        auto b = RandomMatrix(n, rhs);
+        task::Cholesky cholesky(mat);
+        const Matrix& l = cholesky.factor();
+        ASSERT_TRUE_MSG(cholesky.isPositiveDefinite(), "Cholesky::isPositiveDefinite()")
+        ASSERT_TRUE_MSG(MaxAbs(l * l.transposed() - mat) < 1e-9 * MaxAbs(mat), "Cholesky::factor()")
+        ASSERT_TRUE_MSG(MaxAbs(mat * cholesky.solve(b) - b) < 1e-9 * MaxAbs(b), "Cholesky::solve()")
+        auto vector = RandomVector(n);
+        ASSERT_TRUE_MSG(MaxAbs(Column(cholesky.solve(vector)) - cholesky.solve(Column(vector))) < 1e-12,
+                        "Cholesky::solve(vector)")
+        ASSERT_TRUE_MSG(MaxAbs(mat * cholesky.inverse() - Matrix(n, n)) < 1e-9, "Cholesky::inverse()")
+        // Small enough for the determinant not to overflow.
+        auto small = RandomSpd(RandomUInt(1, 10));
+        ASSERT_TRUE_MSG(fabs(task::Cholesky(small).det() / small.det() - 1.) < 1e-9, "Cholesky::det()")
+
+        mat[n - 1][n - 1] = -1.;
+        task::Cholesky indefinite(mat);
+        ASSERT_TRUE_MSG(!indefinite.isPositiveDefinite() && indefinite.det() == 0., "Cholesky of indefinite")
+        ASSERT_EXCEPTION_MSG(indefinite.solve(b), task::SingularMatrixException, "Cholesky::solve()")
+        ASSERT_EXCEPTION_MSG(task::Cholesky(RandomMatrix(n, n + 1)), task::SizeMismatchException,
+                             "Cholesky of non-square")
+    }
+
+
+    {
+        auto cols = RandomUInt(1, 100), rows = cols + RandomUInt(0, 100), rhs = RandomUInt(1, 5);
+        auto mat = RandomMatrix(rows, cols);
+        auto b = RandomMatrix(rows, rhs);
+        task::QR qr(mat);
+        auto q = qr.q();
+        ASSERT_TRUE_MSG(!qr.isRankDeficient(), "QR::isRankDeficient()")
+        ASSERT_TRUE_MSG(MaxAbs(q.transposed() * q - Matrix(cols, cols)) < 1e-12 &&
+                        MaxAbs(q * qr.r() - mat) < 1e-12 * MaxAbs(mat), "QR::q(), QR::r()")
+        // The least-squares residual is orthogonal to the columns of A.
+        auto x = qr.solve(b);
+        ASSERT_TRUE_MSG(MaxAbs(mat.transposed() * (mat * x - b)) < 1e-9 * rows * MaxAbs(b),
+                        "QR::solve() least squares")
+        auto vector = RandomVector(rows);
+        ASSERT_TRUE_MSG(MaxAbs(Column(qr.solve(vector)) - qr.solve(Column(vector))) < 1e-12,
+                        "QR::solve(vector)")
+
+        auto square = RandomMatrix(cols, cols);
+        auto square_b = RandomMatrix(cols, rhs);
+        ASSERT_TRUE_MSG(MaxAbs(square * task::QR(square).solve(square_b) - square_b) < 1e-8,
+                        "QR::solve() of a square system")
+
+        if (cols > 1) {
+            for (size_t i = 0; i < rows; ++i) {
+                mat[i][cols - 1] = mat[i][0] * 2.;
+            }
+            task::QR deficient(mat);
+            ASSERT_TRUE_MSG(deficient.isRankDeficient(), "QR::isRankDeficient()")
+            ASSERT_EXCEPTION_MSG(deficient.solve(b), task::SingularMatrixException, "QR::solve()")
+        }
+        ASSERT_EXCEPTION_MSG(task::QR(RandomMatrix(cols, cols + 1)), task::SizeMismatchException,
+                             "QR of a wide matrix")
+    }
+
+
+    {
+        auto n = RandomUInt(1, 200);
+        auto mat = RandomSpd(n);
+        auto b = RandomVector(n);
+        auto dense = task::conjugateGradient(mat, b);
+        ASSERT_TRUE_MSG(dense.converged && dense.residual <= 1e-10 &&
+                        MaxAbs(mat * Column(dense.x) - Column(b)) < 1e-8 * MaxAbs(Column(b)),
+                        "conjugateGradient() of a dense matrix")
+
+        auto side = RandomUInt(1, 30);
+        auto laplacian = Laplacian(side);
+        auto rhs = RandomVector(side * side);
+        auto sparse = task::conjugateGradient(laplacian, rhs);
+        auto exact = task::Cholesky(laplacian.toDense()).solve(Column(rhs));
+        ASSERT_TRUE_MSG(sparse.converged && MaxAbs(Column(sparse.x) - exact) < 1e-8 * MaxAbs(exact),
+                        "conjugateGradient() of a sparse matrix")
+
+        // Matrix-free, unpreconditioned: the same Laplacian as a stencil.
+        const task::LinearOperator stencil = [side](const std::vector<double>& x, std::vector<double>& y) {
+            for (size_t i = 0; i < x.size(); ++i) {
+                y[i] = 4. * x[i];
+                y[i] -= i % side != 0 ? x[i - 1] : 0.;
+                y[i] -= (i + 1) % side != 0 ? x[i + 1] : 0.;
+                y[i] -= i >= side ? x[i - side] : 0.;
+                y[i] -= i + side < x.size() ? x[i + side] : 0.;
+            }
+        };
+        auto free = task::conjugateGradient(stencil, {}, rhs);
+        ASSERT_TRUE_MSG(free.converged && MaxAbs(Column(free.x) - exact) < 1e-8 * MaxAbs(exact),
+                        "conjugateGradient() of an operator")
+
+        task::ConjugateGradientOptions options;
+        options.max_iterations = 1;
+        options.tolerance = 0.;
+        auto stopped = task::conjugateGradient(laplacian, rhs, options);
+        ASSERT_TRUE_MSG(stopped.iterations == 1 && (!stopped.converged || stopped.residual == 0.),
+                        "conjugateGradient() max_iterations")
+        ASSERT_TRUE_MSG(task::conjugateGradient(mat, std::vector<double>(n)).iterations == 0,
+                        "conjugateGradient() of b = 0")
+        ASSERT_EXCEPTION_MSG(task::conjugateGradient(mat, std::vector<double>(n + 1)),
+                             task::SizeMismatchException, "conjugateGradient() size mismatch")
+    }
+
+
+    {
+        auto n = RandomUInt(1, 100);
+        task::pool::trim();
+        task::pool::resetStats();
+        RandomMatrix(n, n);
+        Matrix identity(n, n);
+        bool cleared = true;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                cleared = cleared && identity[i][j] == (i == j ? 1. : 0.);
+            }
+        }
+        // A recycled buffer is cleared like a fresh one.
+        ASSERT_TRUE_MSG(cleared, "Matrix from a pooled buffer")
+        auto stats = task::pool::stats();
+        if (task::pool::kEnabled) {
+            ASSERT_TRUE_MSG(stats.misses == 1 && stats.hits == 1 && stats.cached == 1,
+                            "Buffer pool hits")
+            // 576 and 640 bytes are both in the class up to 640.
+            Matrix(1, 80);
+            Matrix(1, 72);
+            ASSERT_TRUE_MSG(task::pool::stats().misses == 2 && task::pool::stats().hits == 2,
+                            "Buffer pool size classes")
+            task::pool::trim();
+            ASSERT_TRUE_MSG(task::pool::stats().cached_bytes == 0, "Buffer pool trim()")
+            Matrix(1, 80);
+            ASSERT_TRUE_MSG(task::pool::stats().misses == 3, "Buffer pool after trim()")
+        } else {
+            ASSERT_TRUE_MSG(stats.misses == 2 && stats.hits == 0 && stats.cached_bytes == 0,
+                            "Buffer pool compiled out")
+        }
+    }
+
+
     const int STRESS_TEST_COUNT = argc > 1 ? std::stoi(argv[1]) : 0;
 
+    if (STRESS_TEST_COUNT <= 0) {
+        return 0;
+    }
+
+    // Every stress input is parsed twice, by operator>> and by TextReader,
+    // so both readers stay covered and must agree on each value.
+    std::string input{std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>()};
+    StringReadBuf stream_buf(input), reader_buf(input);
+    std::istream stream_input(&stream_buf), reader_input(&reader_buf);
+    task::TextReader reader(reader_input);
+
+    auto readMatrix = [&](Matrix& mat) {
+        Matrix streamed;
+        stream_input >> streamed;
+        reader.read(mat);
+        ASSERT_TRUE_MSG(stream_input && streamed == mat, "operator>> / TextReader::read()")
+    };
+    auto readScalar = [&]() {
+        double streamed = 0.;
+        stream_input >> streamed;
+        double value = reader.readDouble();
+        ASSERT_TRUE_MSG(stream_input && streamed == value, "operator>> / TextReader::readDouble()")
+        return value;
+    };
+
     REPEAT(STRESS_TEST_COUNT)
     {
         Matrix mat1, mat2, ans, res;
         double scalar;
 
-        std::cin >> mat1 >> mat2 >> ans;
+        readMatrix(mat1);
+        readMatrix(mat2);
+        readMatrix(ans);
 
         if (_iter % 2 == 0) {
             res = mat1;
@@ -227,7 +1237,7 @@ int main(int argc, char** argv) {
         ASSERT_TRUE_MSG(res == ans, "Operator + / +=")
 
 
-        std::cin >> ans;
+        readMatrix(ans);
 
         if (_iter % 2 == 0) {
             res = mat1;
@@ -239,7 +1249,8 @@ int main(int argc, char** argv) {
         ASSERT_TRUE_MSG(res == ans, "Operator - / -=")
 
 
-        std::cin >> mat2 >> ans;
+        readMatrix(mat2);
+        readMatrix(ans);
 
         if (_iter % 2 == 0) {
             res = mat1;
@@ -251,7 +1262,8 @@ int main(int argc, char** argv) {
         ASSERT_TRUE_MSG(res == ans, "Matrix operator * / *=")
 
 
-        std::cin >> scalar >> ans;
+        scalar = readScalar();
+        readMatrix(ans);
 
         if (_iter % 3 == 0) {
             res = mat1;
@@ -265,12 +1277,12 @@ int main(int argc, char** argv) {
         ASSERT_TRUE_MSG(res == ans, "Scalar operator * / *=")
 
 
-        std::cin >> ans;
+        readMatrix(ans);
         ASSERT_TRUE_MSG(-mat1 == ans, "Unary -")
         ASSERT_TRUE_MSG(+mat1 == mat1, "Unary +")
 
 
-        std::cin >> ans;
+        readMatrix(ans);
         if (_iter % 2 == 0) {
             res = mat1;
             res.transpose();
@@ -280,11 +1292,13 @@ int main(int argc, char** argv) {
         ASSERT_TRUE_MSG(res == ans, "Transpose")
 
 
-        std::cin >> mat1 >> scalar;
+        readMatrix(mat1);
+        scalar = readScalar();
         ASSERT_TRUE_MSG(fabs(mat1.trace() - scalar) < EPS, "Trace")
 
 
-        std::cin >> mat2 >> scalar;
+        readMatrix(mat2);
+        scalar = readScalar();
         ASSERT_TRUE_MSG(fabs(mat2.det() - scalar) < EPS * 10., "Determinant")
     }
 